@@ -0,0 +1,444 @@
+/*
+ *  cam_replay.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2016 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "phd.h"
+
+#if defined (REPLAY_CAMERA)
+
+#include "camera.h"
+#include "cam_replay.h"
+
+#include <wx/dir.h>
+
+Camera_ReplayClass::Camera_ReplayClass()
+    : m_nextFrame(0),
+      m_realTime(false),
+      m_startUs(0),
+      m_firstFrameTime(-1.0),
+      m_returnedUs(0),
+      m_processed(0),
+      m_processUs(0),
+      m_processMinUs(0),
+      m_processMaxUs(0),
+      m_framesRead(0),
+      m_readUs(0)
+{
+    Connected = false;
+    Name = _T("Replay");
+    m_hasGuideOutput = true;
+    HasSubframes = false;
+    PropertyDialogType = PROPDLG_WHEN_DISCONNECTED;
+}
+
+static void AddFiles(const wxString& dir, const wxString& spec, wxArrayString *files)
+{
+    wxArrayString found;
+    wxDir::GetAllFiles(dir, &found, spec, wxDIR_FILES);
+    for (unsigned int i = 0; i < found.GetCount(); i++)
+        files->Add(found[i]);
+}
+
+// A directory is replayed in file name order, one frame per file. A single
+// file is replayed one image HDU at a time, skipping any HDUs that are not
+// 2-D images (such as an empty primary HDU).
+bool Camera_ReplayClass::LoadFrameList(const wxString& source)
+{
+    m_frames.clear();
+
+    if (wxDirExists(source))
+    {
+        wxArrayString files;
+        AddFiles(source, "*.fit", &files);
+        AddFiles(source, "*.fits", &files);
+        AddFiles(source, "*.fts", &files);
+        files.Sort();
+
+        for (unsigned int i = 0; i < files.GetCount(); i++)
+        {
+            ReplayFrame frame;
+            frame.path = files[i];
+            frame.hdu = 1;
+            m_frames.push_back(frame);
+        }
+    }
+    else if (wxFileExists(source))
+    {
+        fitsfile *fptr;  // FITS file pointer
+        int status = 0;  // CFITSIO status value MUST be initialized to zero!
+
+        if (PHD_fits_open_diskfile(&fptr, source, READONLY, &status))
+        {
+            Debug.AddLine("Replay camera: cannot open " + source);
+            return true;
+        }
+
+        int nhdus = 0;
+        fits_get_num_hdus(fptr, &nhdus, &status);
+
+        for (int hdu = 1; hdu <= nhdus && !status; hdu++)
+        {
+            int hdutype;
+            int naxis = 0;
+            if (fits_movabs_hdu(fptr, hdu, &hdutype, &status) || hdutype != IMAGE_HDU)
+                continue;
+            fits_get_img_dim(fptr, &naxis, &status);
+            if (naxis != 2)
+                continue;
+
+            ReplayFrame frame;
+            frame.path = source;
+            frame.hdu = hdu;
+            m_frames.push_back(frame);
+        }
+
+        PHD_fits_close_file(fptr);
+    }
+
+    return m_frames.empty();
+}
+
+// frameTime is set to the DATE-OBS of the frame in seconds, or -1 if the
+// frame has no usable timestamp
+bool Camera_ReplayClass::ReadFrame(const ReplayFrame& frame, usImage& img, double *frameTime)
+{
+    bool bError = false;
+    fitsfile *fptr = 0;
+
+    *frameTime = -1.0;
+
+    try
+    {
+        int status = 0;  // CFITSIO status value MUST be initialized to zero!
+
+        if (PHD_fits_open_diskfile(&fptr, frame.path, READONLY, &status))
+        {
+            fptr = 0;
+            throw ERROR_INFO("Replay camera: cannot open " + frame.path);
+        }
+
+        int hdutype;
+        if (fits_movabs_hdu(fptr, frame.hdu, &hdutype, &status) || hdutype != IMAGE_HDU)
+        {
+            throw ERROR_INFO("Replay camera: HDU is not an image");
+        }
+
+        int naxis = 0;
+        fits_get_img_dim(fptr, &naxis, &status);
+        int nhdus = 0;
+        fits_get_num_hdus(fptr, &nhdus, &status);
+        if (frame.hdu == 1 && nhdus == 2 && naxis == 0)
+        {
+            // compressed image, stored after an empty primary HDU, as
+            // usImage::Load reads it
+            if (fits_movabs_hdu(fptr, 2, &hdutype, &status) == 0 && hdutype == IMAGE_HDU)
+                fits_get_img_dim(fptr, &naxis, &status);
+        }
+        if (status || naxis != 2)
+        {
+            throw ERROR_INFO("Replay camera: not a 2-D image");
+        }
+
+        long fsize[2];
+        fits_get_img_size(fptr, 2, fsize, &status);
+        if (status)
+        {
+            throw ERROR_INFO("Replay camera: cannot get image size");
+        }
+
+        if (img.Init((int) fsize[0], (int) fsize[1]))
+        {
+            throw ERROR_INFO("Replay camera: memory allocation error");
+        }
+
+        long fpixel[2] = { 1, 1 };
+        if (fits_read_pix(fptr, TUSHORT, fpixel, img.NPixels, NULL, img.ImageData, NULL, &status))
+        {
+            throw ERROR_INFO("Replay camera: error reading image data");
+        }
+
+        float exposure;
+        status = 0;
+        if (fits_read_key(fptr, TFLOAT, const_cast<char *>("EXPOSURE"), &exposure, NULL, &status) == 0)
+            img.ImgExpDur = (int) (exposure * 1000.0);
+
+        // subframe written by usImage::Save
+        int subframe[4];
+        status = 0;
+        fits_read_key(fptr, TINT, const_cast<char *>("XORGSUB"), &subframe[0], NULL, &status);
+        fits_read_key(fptr, TINT, const_cast<char *>("YORGSUB"), &subframe[1], NULL, &status);
+        fits_read_key(fptr, TINT, const_cast<char *>("XSIZSUB"), &subframe[2], NULL, &status);
+        fits_read_key(fptr, TINT, const_cast<char *>("YSIZSUB"), &subframe[3], NULL, &status);
+        if (status == 0)
+            img.Subframe = wxRect(subframe[0], subframe[1], subframe[2], subframe[3]).Intersect(wxRect(img.Size));
+        else
+            img.Subframe = wxRect();
+
+        // DATE-OBS is YYYY-MM-DDThh:mm:ss with optional fractional seconds
+        char dateobs[FLEN_VALUE];
+        status = 0;
+        if (fits_read_key(fptr, TSTRING, const_cast<char *>("DATE-OBS"), dateobs, NULL, &status) == 0)
+        {
+            wxString s(dateobs);
+            wxDateTime dt;
+            if (dt.ParseISOCombined(s.Left(19)))
+            {
+                dt.MakeFromTimezone(wxDateTime::UTC);
+                double frac = 0.0;
+                s.Mid(19).ToCDouble(&frac);
+                img.ImgStartTime = dt.GetTicks();
+                *frameTime = (double) img.ImgStartTime + frac;
+            }
+        }
+    }
+    catch (wxString Msg)
+    {
+        POSSIBLY_UNUSED(Msg);
+        bError = true;
+    }
+
+    if (fptr)
+    {
+        PHD_fits_close_file(fptr);
+    }
+
+    return bError;
+}
+
+wxString Camera_ReplayClass::Summary(void) const
+{
+    if (!m_processed)
+        return wxString::Format(_("%u frames replayed"), m_framesRead);
+
+    return wxString::Format(_("%u frames replayed, processing time per frame %.1f ms (min %.1f ms, max %.1f ms), frame read %.1f ms"),
+        m_framesRead, (double) m_processUs / m_processed / 1000.0, (double) m_processMinUs / 1000.0,
+        (double) m_processMaxUs / 1000.0, (double) m_readUs / m_framesRead / 1000.0);
+}
+
+bool Camera_ReplayClass::Connect()
+{
+    wxString source = pConfig->Profile.GetString("/ReplayCam/source", wxEmptyString);
+    m_realTime = pConfig->Profile.GetBoolean("/ReplayCam/real_time", false);
+
+    if (source.IsEmpty())
+    {
+        wxMessageBox(_("Choose the recorded frames to replay in the Replay camera settings."), _("Error"), wxOK | wxICON_ERROR);
+        return true;
+    }
+
+    if (LoadFrameList(source))
+    {
+        wxMessageBox(wxString::Format(_("No guide frames found in %s"), source), _("Error"), wxOK | wxICON_ERROR);
+        return true;
+    }
+
+    usImage img;
+    double frameTime;
+    if (ReadFrame(m_frames[0], img, &frameTime))
+    {
+        wxMessageBox(wxString::Format(_("Cannot read the first frame from %s"), m_frames[0].path), _("Error"), wxOK | wxICON_ERROR);
+        return true;
+    }
+
+    FullSize = img.Size;
+    m_nextFrame = 0;
+    m_startUs = 0;
+    m_returnedUs = 0;
+    m_processed = 0;
+    m_processUs = m_processMinUs = m_processMaxUs = 0;
+    m_framesRead = 0;
+    m_readUs = 0;
+
+    Debug.AddLine("Replay camera: %u frames from %s, %s", (unsigned int) m_frames.size(), source,
+        m_realTime ? "real time" : "as fast as possible");
+
+    Connected = true;
+    return false;
+}
+
+bool Camera_ReplayClass::Disconnect()
+{
+    if (m_framesRead)
+        Debug.AddLine("Replay camera: " + Summary());
+
+    m_frames.clear();
+    Connected = false;
+    return false;
+}
+
+void Camera_ReplayClass::InitCapture()
+{
+    // restart the pacing and do not count the time between capture loops as processing time
+    m_startUs = 0;
+    m_returnedUs = 0;
+}
+
+bool Camera_ReplayClass::Capture(int duration, usImage& img, int options, const wxRect& subframe)
+{
+    wxLongLong_t const now = LatencyStats::Now();
+
+    if (m_returnedUs)
+    {
+        wxLongLong_t const us = now - m_returnedUs;
+        if (!m_processed || us < m_processMinUs)
+            m_processMinUs = us;
+        if (us > m_processMaxUs)
+            m_processMaxUs = us;
+        m_processUs += us;
+        ++m_processed;
+    }
+
+    if (m_nextFrame >= m_frames.size())
+    {
+        wxString summary = Summary();
+        Debug.AddLine("Replay camera finished: " + summary);
+        pFrame->Alert(_("Replay finished: ") + summary, wxICON_INFORMATION);
+        // start over the next time
+        m_nextFrame = 0;
+        m_returnedUs = 0;
+        return true;
+    }
+
+    double frameTime;
+    if (ReadFrame(m_frames[m_nextFrame], img, &frameTime))
+    {
+        DisconnectWithAlert(wxString::Format(_("Cannot read replay frame %s"), m_frames[m_nextFrame].path));
+        return true;
+    }
+
+    ++m_nextFrame;
+    ++m_framesRead;
+
+    wxLongLong_t const readDone = LatencyStats::Now();
+    m_readUs += readDone - now;
+
+    if (m_realTime)
+    {
+        // keep the recorded spacing between frames, or fall back to the
+        // exposure time if the frames are not time-stamped
+        long waitMs;
+        if (m_startUs && frameTime >= 0.0 && m_firstFrameTime >= 0.0)
+            waitMs = (long) ((frameTime - m_firstFrameTime) * 1000.0 - (double) (readDone - m_startUs) / 1000.0);
+        else
+            waitMs = (img.ImgExpDur ? img.ImgExpDur : duration) - (long) ((readDone - now) / 1000);
+
+        if (waitMs > 0 && WorkerThread::MilliSleep(waitMs, WorkerThread::INT_ANY))
+            return true;
+    }
+
+    if (!m_startUs)
+    {
+        m_startUs = LatencyStats::Now();
+        m_firstFrameTime = frameTime;
+    }
+
+    if (options & CAPTURE_SUBTRACT_DARK) SubtractDark(img);
+
+    m_returnedUs = LatencyStats::Now();
+
+    return false;
+}
+
+bool Camera_ReplayClass::ST4PulseGuideScope(int direction, int duration)
+{
+    // the recorded frames do not respond to guide pulses; only the pulse
+    // duration is simulated, and only when replaying in real time
+    if (m_realTime)
+        WorkerThread::MilliSleep(duration, WorkerThread::INT_ANY);
+    return false;
+}
+
+struct ReplayCamDialog : public wxDialog
+{
+    wxTextCtrl *m_source;
+    wxCheckBox *m_realTime;
+
+    ReplayCamDialog(wxWindow *parent);
+    void OnBrowseDir(wxCommandEvent& evt);
+    void OnBrowseFile(wxCommandEvent& evt);
+};
+
+ReplayCamDialog::ReplayCamDialog(wxWindow *parent)
+    : wxDialog(parent, wxID_ANY, _("Replay Camera"))
+{
+    wxBoxSizer *pVSizer = new wxBoxSizer(wxVERTICAL);
+
+    wxBoxSizer *pSourceSizer = new wxBoxSizer(wxHORIZONTAL);
+    pSourceSizer->Add(new wxStaticText(this, wxID_ANY, _("Frames: ")), wxSizerFlags().Center());
+    m_source = new wxTextCtrl(this, wxID_ANY, pConfig->Profile.GetString("/ReplayCam/source", wxEmptyString),
+        wxDefaultPosition, wxSize(StringWidth(this, "M") * 30, -1));
+    m_source->SetToolTip(_("A folder of FITS guide frames, replayed in file name order, or a FITS file with a guide frame in each image HDU"));
+    pSourceSizer->Add(m_source, wxSizerFlags(1).Expand());
+    wxButton *pDirBtn = new wxButton(this, wxID_ANY, _("Folder..."));
+    pDirBtn->Bind(wxEVT_COMMAND_BUTTON_CLICKED, &ReplayCamDialog::OnBrowseDir, this);
+    pSourceSizer->Add(pDirBtn, wxSizerFlags().Border(wxLEFT, 5));
+    wxButton *pFileBtn = new wxButton(this, wxID_ANY, _("File..."));
+    pFileBtn->Bind(wxEVT_COMMAND_BUTTON_CLICKED, &ReplayCamDialog::OnBrowseFile, this);
+    pSourceSizer->Add(pFileBtn, wxSizerFlags().Border(wxLEFT, 5));
+    pVSizer->Add(pSourceSizer, wxSizerFlags().Border(wxALL, 10).Expand());
+
+    m_realTime = new wxCheckBox(this, wxID_ANY, _("Replay in real time"));
+    m_realTime->SetValue(pConfig->Profile.GetBoolean("/ReplayCam/real_time", false));
+    m_realTime->SetToolTip(_("Deliver frames at the rate they were recorded. When unchecked, frames are delivered as fast as they can be processed."));
+    pVSizer->Add(m_realTime, wxSizerFlags().Border(wxLEFT | wxRIGHT, 10));
+
+    pVSizer->Add(CreateButtonSizer(wxOK | wxCANCEL), wxSizerFlags().Border(wxALL, 10).Expand());
+
+    SetSizerAndFit(pVSizer);
+}
+
+void ReplayCamDialog::OnBrowseDir(wxCommandEvent& evt)
+{
+    wxString dir = wxDirSelector(_("Choose a folder of guide frames"), m_source->GetValue(), wxDD_DEFAULT_STYLE | wxDD_DIR_MUST_EXIST, wxDefaultPosition, this);
+    if (!dir.IsEmpty())
+        m_source->SetValue(dir);
+}
+
+void ReplayCamDialog::OnBrowseFile(wxCommandEvent& evt)
+{
+    wxString file = wxFileSelector(_("Choose a file of guide frames"), wxEmptyString, wxEmptyString, wxEmptyString,
+        _("FITS files (*.fit;*.fits;*.fts)|*.fit;*.fits;*.fts"), wxFD_OPEN | wxFD_FILE_MUST_EXIST, this);
+    if (!file.IsEmpty())
+        m_source->SetValue(file);
+}
+
+void Camera_ReplayClass::ShowPropertyDialog()
+{
+    ReplayCamDialog dlg(pFrame);
+    if (dlg.ShowModal() == wxID_OK)
+    {
+        pConfig->Profile.SetString("/ReplayCam/source", dlg.m_source->GetValue());
+        pConfig->Profile.SetBoolean("/ReplayCam/real_time", dlg.m_realTime->GetValue());
+    }
+}
+
+#endif // REPLAY_CAMERA
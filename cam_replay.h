@@ -0,0 +1,80 @@
+/*
+ *  cam_replay.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2016 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef CAM_REPLAY_H_INCLUDED
+#define CAM_REPLAY_H_INCLUDED
+
+// A camera that plays back recorded guide frames, either a directory of FITS
+// files or one FITS file with a frame in each image HDU, so the same sky data
+// can be run through the guiding pipeline of different builds.
+class Camera_ReplayClass : public GuideCamera
+{
+    struct ReplayFrame
+    {
+        wxString path;
+        int hdu;                // 1-based HDU number
+    };
+
+    std::vector<ReplayFrame> m_frames;
+    unsigned int m_nextFrame;
+    bool m_realTime;            // play frames back at the recorded rate, otherwise as fast as possible
+
+    wxLongLong_t m_startUs;     // when the first frame was returned
+    double m_firstFrameTime;    // DATE-OBS of the first frame, seconds
+    wxLongLong_t m_returnedUs;  // when the last frame was returned
+
+    // processing time per frame: from returning a frame to the next Capture call
+    unsigned int m_processed;
+    wxLongLong_t m_processUs;
+    wxLongLong_t m_processMinUs;
+    wxLongLong_t m_processMaxUs;
+    unsigned int m_framesRead;
+    wxLongLong_t m_readUs;
+
+    bool LoadFrameList(const wxString& source);
+    bool ReadFrame(const ReplayFrame& frame, usImage& img, double *frameTime);
+    wxString Summary(void) const;
+
+public:
+    Camera_ReplayClass();
+    bool Capture(int duration, usImage& img, int options, const wxRect& subframe);
+    bool Connect();
+    bool Disconnect();
+    void InitCapture();
+    void ShowPropertyDialog();
+    bool HasNonGuiCapture(void) { return true; }
+    bool ST4HasNonGuiMove(void) { return true; }
+    bool ST4PulseGuideScope(int direction, int duration);
+};
+
+#endif // CAM_REPLAY_H_INCLUDED
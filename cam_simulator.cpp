@@ -81,6 +81,9 @@ struct SimCamParams
     static bool show_comet;
     static double comet_rate_x;
     static double comet_rate_y;
+    static double time_scale;
+    static unsigned int rng_seed;
+    static bool video_mode;
 };
 
 unsigned int SimCamParams::width = 752;          // simulated camera image width
@@ -106,6 +109,9 @@ double SimCamParams::custom_pe_period;
 bool SimCamParams::show_comet;
 double SimCamParams::comet_rate_x;
 double SimCamParams::comet_rate_y;
+double SimCamParams::time_scale;                 // simulated seconds per real second
+unsigned int SimCamParams::rng_seed;             // random number seed for noise and seeing, 0 = seed from the clock
+bool SimCamParams::video_mode;                   // stream frames continuously through the camera streaming interface
 
 // Note: these are all in units appropriate for the UI
 #define NR_STARS_DEFAULT 20
@@ -135,6 +141,10 @@ double SimCamParams::comet_rate_y;
 #define COMET_RATE_X_DEFAULT 555.0              // pixels per hour
 #define COMET_RATE_Y_DEFAULT -123.4              // pixels per hour
 #define SIM_FILE_DISPLACEMENTS_DEFAULT "star_displacements.csv"
+#define TIME_SCALE_DEFAULT 1.0                  // real time
+#define TIME_SCALE_MAX 100.0
+#define RNG_SEED_DEFAULT 0
+#define VIDEO_MODE_DEFAULT false
 
 // Needed to handle legacy registry values that may no longer be in correct units or range
 static double range_check(double thisval, double minval, double maxval)
@@ -170,6 +180,10 @@ static void load_sim_params()
     SimCamParams::show_comet = pConfig->Profile.GetBoolean("/SimCam/show_comet", SHOW_COMET_DEFAULT);
     SimCamParams::comet_rate_x = pConfig->Profile.GetDouble("/SimCam/comet_rate_x", COMET_RATE_X_DEFAULT);
     SimCamParams::comet_rate_y = pConfig->Profile.GetDouble("/SimCam/comet_rate_y", COMET_RATE_Y_DEFAULT);
+
+    SimCamParams::time_scale = range_check(pConfig->Profile.GetDouble("/SimCam/time_scale", TIME_SCALE_DEFAULT), 1.0, TIME_SCALE_MAX);
+    SimCamParams::rng_seed = pConfig->Profile.GetInt("/SimCam/rng_seed", RNG_SEED_DEFAULT);
+    SimCamParams::video_mode = pConfig->Profile.GetBoolean("/SimCam/video_mode", VIDEO_MODE_DEFAULT);
 }
 
 static void save_sim_params()
@@ -192,6 +206,17 @@ static void save_sim_params()
     pConfig->Profile.SetBoolean("/SimCam/show_comet", SimCamParams::show_comet);
     pConfig->Profile.SetDouble("/SimCam/comet_rate_x", SimCamParams::comet_rate_x);
     pConfig->Profile.SetDouble("/SimCam/comet_rate_y", SimCamParams::comet_rate_y);
+    pConfig->Profile.SetDouble("/SimCam/time_scale", SimCamParams::time_scale);
+    pConfig->Profile.SetInt("/SimCam/rng_seed", SimCamParams::rng_seed);
+    pConfig->Profile.SetBoolean("/SimCam/video_mode", SimCamParams::video_mode);
+}
+
+// The simulated devices run on a clock that is time_scale times faster than
+// real time: the simulator's clock is scaled up, and exposures, guide pulses
+// and AO steps only take 1/time_scale of their duration in real time.
+static int RealTimeMs(int simTimeMs)
+{
+    return (int) (simTimeMs / SimCamParams::time_scale);
 }
 
 #ifdef STEPGUIDER_SIMULATOR
@@ -254,7 +279,7 @@ bool StepGuiderSimulator::Step(GUIDE_DIRECTION direction, int steps)
 {
     // parent class maintains x/y offsets, so nothing to do here. Just simulate a delay.
     enum { LATENCY_MS_PER_STEP = 5 };
-    wxMilliSleep(steps * LATENCY_MS_PER_STEP);
+    wxMilliSleep(RealTimeMs(steps * LATENCY_MS_PER_STEP));
     return false;
 }
 
@@ -353,7 +378,7 @@ struct SimCamState
     BacklashVal dec_ofs;     // simulate backlash in DEC
     double cum_dec_drift;    // cumulative dec drift
     wxStopWatch timer;       // platform-independent timer
-    long last_exposure_time; // last expoure time, milliseconds
+    long last_exposure_time; // last expoure time, milliseconds (simulated time)
 
 #ifdef SIMDEBUG
     wxFFile DebugFile;
@@ -374,6 +399,7 @@ struct SimCamState
     bool ReadNextImage(usImage& img, const wxRect& subframe);
 #endif
 
+    long SimTime() const { return (long) (timer.Time() * SimCamParams::time_scale); }
     void Initialize();
     void FillImage(usImage& img, const wxRect& subframe, int exptime, int gain, int offset);
 };
@@ -412,11 +438,19 @@ void SimCamState::Initialize()
         hotpx[i].x = rand() % width;
         hotpx[i].y = rand() % height;
     }
-    srand(clock());
+    if (SimCamParams::rng_seed)
+    {
+        // repeatable noise and seeing, for comparing guiding runs
+        srand(SimCamParams::rng_seed);
+        Debug.AddLine("Camera simulator: random seed %u, time scale %.1f", SimCamParams::rng_seed, SimCamParams::time_scale);
+    }
+    else
+        srand(clock());
     ra_ofs = 0.;
     dec_ofs = BacklashVal(SimCamParams::dec_backlash);
     cum_dec_drift = 0.;
     last_exposure_time = 0;
+    timer.Start();
 
 #if SIMMODE == 1
     dirStarted = false;
@@ -818,7 +852,7 @@ void SimCamState::FillImage(usImage& img, const wxRect& subframe, int exptime, i
         }
     }
 #else // SIM_FILE_DISPLACEMENTS
-    long const cur_time = timer.Time();
+    long const cur_time = SimTime();
     long const delta_time_ms = last_exposure_time - cur_time;
     last_exposure_time = cur_time;
 
@@ -958,7 +992,13 @@ void SimCamState::FillImage(usImage& img, const wxRect& subframe, int exptime, i
 }
 
 Camera_SimClass::Camera_SimClass()
-    : sim(new SimCamState())
+    : sim(new SimCamState()),
+      m_streamThread(0),
+      m_streamWakeup(m_streamLock),
+      m_streamStop(false),
+      m_streamDuration(0),
+      m_streamOptions(0),
+      m_streamGeneration(0)
 {
     Connected = false;
     Name = _T("Simulator");
@@ -1003,12 +1043,15 @@ bool Camera_SimClass::Connect()
 
 bool Camera_SimClass::Disconnect()
 {
+    StopStream();
     Connected = false;
     return false;
 }
 
 Camera_SimClass::~Camera_SimClass()
 {
+    StopStream();
+
 #ifdef SIMDEBUG
     sim->DebugFile.Close();
 #endif
@@ -1067,18 +1110,21 @@ static void fill_noise(usImage& img, const wxRect& subframe, int exptime, int ga
 }
 #endif // SIMMODE == 3
 
-bool Camera_SimClass::Capture(int duration, usImage& img, int options, const wxRect& subframeArg)
+// generate the frame, without waiting for the exposure time
+bool Camera_SimClass::RenderFrame(int duration, usImage& img, int options, const wxRect& subframeArg)
 {
     wxRect subframe(subframeArg);
-    CameraWatchdog watchdog(duration, GetTimeoutMs());
 
 #if SIMMODE == 1
 
     if (!UseSubframes)
         subframe = wxRect();
 
-    if (sim->ReadNextImage(img, subframe))
-        return true;
+    {
+        wxCriticalSectionLocker lock(m_simLock);
+        if (sim->ReadNextImage(img, subframe))
+            return true;
+    }
 
     FullSize = img.Size;
 
@@ -1106,7 +1152,10 @@ bool Camera_SimClass::Capture(int duration, usImage& img, int options, const wxR
 
     fill_noise(img, subframe, exptime, gain, offset);
 
-    sim->FillImage(img, subframe, exptime, gain, offset);
+    {
+        wxCriticalSectionLocker lock(m_simLock);
+        sim->FillImage(img, subframe, exptime, gain, offset);
+    }
 
     if (usingSubframe)
         img.Subframe = subframe;
@@ -1115,10 +1164,21 @@ bool Camera_SimClass::Capture(int duration, usImage& img, int options, const wxR
 
 #endif // SIMMODE == 1
 
+    return false;
+}
+
+bool Camera_SimClass::Capture(int duration, usImage& img, int options, const wxRect& subframe)
+{
+    CameraWatchdog watchdog(duration, GetTimeoutMs());
+
+    if (RenderFrame(duration, img, options, subframe))
+        return true;
+
     long elapsed = watchdog.Time();
-    if (elapsed < duration)
+    long const exposure = RealTimeMs(duration);
+    if (elapsed < exposure)
     {
-        if (WorkerThread::MilliSleep(duration - elapsed, WorkerThread::INT_ANY))
+        if (WorkerThread::MilliSleep(exposure - elapsed, WorkerThread::INT_ANY))
             return true;
         if (watchdog.Expired())
         {
@@ -1130,7 +1190,141 @@ bool Camera_SimClass::Capture(int duration, usImage& img, int options, const wxR
     return false;
 }
 
-bool Camera_SimClass::ST4PulseGuideScope(int direction, int duration)
+// In video mode the simulator behaves like a camera running continuous
+// capture: a thread exposes frames back to back and pushes them into the
+// stream frame ring, whether or not the guider is ready for them.
+class Camera_SimClass::StreamThread : public wxThread
+{
+    Camera_SimClass *m_cam;
+
+public:
+    StreamThread(Camera_SimClass *cam)
+        : wxThread(wxTHREAD_JOINABLE), m_cam(cam) { }
+
+    ExitCode Entry(void)
+    {
+        m_cam->StreamFrames();
+        return 0;
+    }
+};
+
+bool Camera_SimClass::HasStreaming(void)
+{
+    return SimCamParams::video_mode;
+}
+
+void Camera_SimClass::StreamFrames(void)
+{
+    usImage img;
+
+    wxMutexLocker lock(m_streamLock);
+
+    while (!m_streamStop)
+    {
+        int const duration = m_streamDuration;
+        int const options = m_streamOptions;
+        wxRect const subframe = m_streamSubframe;
+        unsigned int const generation = m_streamGeneration;
+
+        m_streamLock.Unlock();
+
+        wxStopWatch swatch;
+        wxLongLong_t startUs = LatencyStats::Now();
+        bool err = RenderFrame(duration, img, options, subframe);
+        img.ImgExposureStartUs = startUs;
+        img.ImgExpDur = duration;
+        img.InitImgStartTime();
+
+        m_streamLock.Lock();
+
+        if (err)
+        {
+            Debug.AddLine("Camera simulator: could not render a frame, streaming stopped");
+            m_streamFrames.Close();
+            break;
+        }
+
+        // wait out the rest of the exposure, unless the settings change
+        long remaining;
+        while (!m_streamStop && generation == m_streamGeneration && (remaining = RealTimeMs(duration) - swatch.Time()) > 0)
+            m_streamWakeup.WaitTimeout(remaining);
+
+        if (!m_streamStop && generation == m_streamGeneration)
+            m_streamFrames.Push(img);
+    }
+}
+
+bool Camera_SimClass::StartStream(int duration, int options, const wxRect& subframe)
+{
+    {
+        wxMutexLocker lock(m_streamLock);
+
+        if (m_streamThread)
+        {
+            if (duration != m_streamDuration || options != m_streamOptions)
+            {
+                // frames taken with the old settings are no use
+                ++m_streamGeneration;
+                m_streamFrames.Clear();
+                Debug.AddLine("Camera simulator: stream settings changed, d=%d o=%x", duration, options);
+            }
+
+            m_streamDuration = duration;
+            m_streamOptions = options;
+            m_streamSubframe = subframe;
+            m_streamWakeup.Signal();
+            return false;
+        }
+
+        m_streamDuration = duration;
+        m_streamOptions = options;
+        m_streamSubframe = subframe;
+        m_streamStop = false;
+    }
+
+    m_streamFrames.Open();
+
+    StreamThread *thread = new StreamThread(this);
+
+    if (thread->Create() != wxTHREAD_NO_ERROR || thread->Run() != wxTHREAD_NO_ERROR)
+    {
+        Debug.AddLine("Camera simulator: could not start streaming thread");
+        delete thread;
+        m_streamFrames.Close();
+        return true;
+    }
+
+    wxMutexLocker lock(m_streamLock);
+    m_streamThread = thread;
+
+    Debug.AddLine("Camera simulator: streaming started, d=%d o=%x", duration, options);
+
+    return false;
+}
+
+void Camera_SimClass::StopStream(void)
+{
+    StreamThread *thread;
+
+    {
+        wxMutexLocker lock(m_streamLock);
+        m_streamStop = true;
+        m_streamWakeup.Signal();
+        thread = m_streamThread;
+        m_streamThread = 0;
+    }
+
+    m_streamFrames.Close();
+
+    if (thread)
+    {
+        thread->Wait();
+        delete thread;
+        Debug.AddLine("Camera simulator: streaming stopped, %u frames dropped", m_streamFrames.Dropped());
+    }
+}
+
+static bool ApplyGuidePulse(SimCamState *sim, int direction, int duration)
 {
     double d = (SimCamParams::guide_rate * duration / 1000.0) * SimCamParams::inverse_imagescale;
 
@@ -1150,7 +1344,29 @@ bool Camera_SimClass::ST4PulseGuideScope(int direction, int duration)
     case SOUTH:   sim->dec_ofs.incr(-d); break;
     default: return true;
     }
-    WorkerThread::MilliSleep(duration, WorkerThread::INT_ANY);
+    return false;
+}
+
+bool Camera_SimClass::ST4PulseGuideScope(int direction, int duration)
+{
+    {
+        wxCriticalSectionLocker lock(m_simLock);
+        if (ApplyGuidePulse(sim, direction, duration))
+            return true;
+    }
+    WorkerThread::MilliSleep(RealTimeMs(duration), WorkerThread::INT_ANY);
+    return false;
+}
+
+bool Camera_SimClass::ST4PulseGuideScopeBothAxes(int raDirection, int raDuration, int decDirection, int decDuration)
+{
+    {
+        wxCriticalSectionLocker lock(m_simLock);
+        if (ApplyGuidePulse(sim, raDirection, raDuration) || ApplyGuidePulse(sim, decDirection, decDuration))
+            return true;
+    }
+    // the two pulses run at the same time
+    WorkerThread::MilliSleep(RealTimeMs(wxMax(raDuration, decDuration)), WorkerThread::INT_ANY);
     return false;
 }
 
@@ -1166,6 +1382,7 @@ static PierSide OtherSide(PierSide side)
 
 void Camera_SimClass::FlipPierSide(void)
 {
+    wxCriticalSectionLocker lock(m_simLock);
     SimCamParams::pier_side = OtherSide(SimCamParams::pier_side);
     Debug.AddLine("CamSimulator FlipPierSide: side = %d  cam_angle = %.1f", SimCamParams::pier_side, SimCamParams::cam_angle);
 }
@@ -1246,6 +1463,9 @@ struct SimCamDialog : public wxDialog
     wxSpinCtrlDouble *pSeeingSpin;
     wxCheckBox* showComet;
     wxCheckBox* pCloudsCbx;
+    wxSpinCtrlDouble *pTimeScaleSpin;
+    wxSpinCtrl *pRngSeedSpin;
+    wxCheckBox *pVideoModeCbx;
     wxCheckBox *pUsePECbx;
     wxCheckBox *pReverseDecPulseCbx;
     PierSide pPierSide;
@@ -1477,9 +1697,21 @@ SimCamDialog::SimCamDialog(wxWindow *parent)
     showComet->SetValue(SimCamParams::show_comet);
     pCloudsCbx = new wxCheckBox(this, wxID_ANY, _("Star fading due to clouds"));
     pCloudsCbx->SetValue(SimCamParams::clouds_inten > 0);
+    wxFlexGridSizer *pClockTable = new wxFlexGridSizer(1, 4, 15, 15);
+    pTimeScaleSpin = NewSpinner(this, SimCamParams::time_scale, 1.0, TIME_SCALE_MAX, 1.0,
+        _("Simulated time runs this many times faster than real time. Exposures, guide pulses and drift are all sped up."));
+    AddTableEntryPair(this, pClockTable, _("Time scale"), pTimeScaleSpin);
+    pRngSeedSpin = new wxSpinCtrl(this, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize, wxSP_ARROW_KEYS, 0, 999999, SimCamParams::rng_seed);
+    pRngSeedSpin->SetToolTip(_("Random number seed for the simulated noise and seeing. Use the same non-zero seed to repeat a session, 0 for a different session every time."));
+    AddTableEntryPair(this, pClockTable, _("Random seed"), pRngSeedSpin);
     pSessionGroup->Add(pSessionTable);
+    pVideoModeCbx = new wxCheckBox(this, wxID_ANY, _("Video mode"));
+    pVideoModeCbx->SetValue(SimCamParams::video_mode);
+    pVideoModeCbx->SetToolTip(_("Expose frames continuously, like a video camera, and hand them to the guider as they arrive"));
+    pSessionGroup->Add(pClockTable);
     pSessionGroup->Add(showComet);
     pSessionGroup->Add(pCloudsCbx);
+    pSessionGroup->Add(pVideoModeCbx);
 
     pVSizer->Add(pCamGroup, wxSizerFlags().Border(wxALL, 10).Expand());
     pVSizer->Add(pMountGroup, wxSizerFlags().Border(wxRIGHT | wxLEFT, 10));
@@ -1537,6 +1769,9 @@ void SimCamDialog::OnReset(wxCommandEvent& event)
     UpdatePierSideLabel();
     showComet->SetValue(SHOW_COMET_DEFAULT);
     pCloudsCbx->SetValue(false);
+    pTimeScaleSpin->SetValue(TIME_SCALE_DEFAULT);
+    pRngSeedSpin->SetValue(RNG_SEED_DEFAULT);
+    pVideoModeCbx->SetValue(VIDEO_MODE_DEFAULT);
 }
 
 void SimCamDialog::OnPierFlip(wxCommandEvent& event)
@@ -1562,6 +1797,12 @@ void Camera_SimClass::ShowPropertyDialog()
     SimCamParams::inverse_imagescale = 1.0/imageScale;              // keep current - might have gotten changed in brain dialog
     if (dlg.ShowModal() == wxID_OK)
     {
+        // stop the stream first; its thread takes m_simLock to render
+        if (!dlg.pVideoModeCbx->GetValue())
+            StopStream();
+
+        wxCriticalSectionLocker lock(m_simLock);
+
         SimCamParams::nr_stars = dlg.pStarsSlider->GetValue();
         SimCamParams::nr_hot_pixels = dlg.pHotpxSlider->GetValue();
         SimCamParams::noise_multiplier = (double) dlg.pNoiseSlider->GetValue() * NOISE_MAX / 100.0;
@@ -1585,6 +1826,9 @@ void Camera_SimClass::ShowPropertyDialog()
         SimCamParams::reverse_dec_pulse_on_west_side = dlg.pReverseDecPulseCbx->GetValue();
         SimCamParams::show_comet = dlg.showComet->GetValue();
         SimCamParams::clouds_inten = dlg.pCloudsCbx->GetValue() ? CLOUDS_INTEN_DEFAULT : 0;
+        SimCamParams::time_scale = dlg.pTimeScaleSpin->GetValue();
+        SimCamParams::rng_seed = dlg.pRngSeedSpin->GetValue();
+        SimCamParams::video_mode = dlg.pVideoModeCbx->GetValue();
         save_sim_params();
         sim->Initialize();
     }
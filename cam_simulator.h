@@ -40,7 +40,23 @@ struct SimCamState;
 
 class Camera_SimClass : public GuideCamera
 {
+    class StreamThread;
+
     SimCamState *sim;
+    wxCriticalSection m_simLock;        // sim, changed by pulses while the stream thread renders
+
+    StreamThread *m_streamThread;
+    wxMutex m_streamLock;
+    wxCondition m_streamWakeup;
+    bool m_streamStop;
+    int m_streamDuration;
+    int m_streamOptions;
+    wxRect m_streamSubframe;
+    unsigned int m_streamGeneration;    // changes when frames in progress must be discarded
+
+    bool RenderFrame(int duration, usImage& img, int options, const wxRect& subframe);
+    void StreamFrames(void);
+
 public:
     Camera_SimClass();
     ~Camera_SimClass();
@@ -50,8 +66,13 @@ public:
     void         InitCapture() { return; }
     void         ShowPropertyDialog();
     bool         HasNonGuiCapture(void) { return true; }
+    bool         HasStreaming(void);
+    bool         StartStream(int duration, int options, const wxRect& subframe);
+    void         StopStream(void);
     bool         ST4HasNonGuiMove(void) { return true; }
     bool         ST4PulseGuideScope (int direction, int duration);
+    bool         ST4CanPulseBothAxes(void) { return true; }
+    bool         ST4PulseGuideScopeBothAxes(int raDirection, int raDuration, int decDirection, int decDuration);
     PierSide     SideOfPier(void) const;
     void         FlipPierSide(void);
 };
@@ -132,6 +132,10 @@ wxSize UNDEFINED_FRAME_SIZE = wxSize(0, 0);
 #include "cam_simulator.h"
 //#endif
 
+#if defined (REPLAY_CAMERA)
+#include "cam_replay.h"
+#endif
+
 #if defined (MEADE_DSI)
 #include "cam_MeadeDSI.h"
 #endif
@@ -204,6 +208,106 @@ GuideCamera::~GuideCamera(void)
     ClearDarks();
 }
 
+CameraFrameRing::CameraFrameRing(void)
+    : m_frameReady(m_lock),
+      m_head(0),
+      m_count(0),
+      m_dropped(0),
+      m_open(false)
+{
+}
+
+// move the pixels and frame details from src to dst; returns true on error
+static bool MoveFrame(usImage& dst, usImage& src)
+{
+    if (dst.Init(src.Size))
+        return true;
+    dst.SwapImageData(src);
+    dst.Subframe = src.Subframe;
+    dst.ImgStartTime = src.ImgStartTime;
+    dst.ImgExpDur = src.ImgExpDur;
+    dst.ImgStackCnt = src.ImgStackCnt;
+    dst.ImgExposureStartUs = src.ImgExposureStartUs;
+    dst.ImgCapturedUs = src.ImgCapturedUs;
+    return false;
+}
+
+void CameraFrameRing::Open(void)
+{
+    wxMutexLocker lock(m_lock);
+    m_head = m_count = m_dropped = 0;
+    m_open = true;
+}
+
+void CameraFrameRing::Close(void)
+{
+    wxMutexLocker lock(m_lock);
+    m_open = false;
+    m_count = 0;
+    m_frameReady.Broadcast();
+}
+
+void CameraFrameRing::Clear(void)
+{
+    wxMutexLocker lock(m_lock);
+    m_count = 0;
+}
+
+bool CameraFrameRing::IsOpen(void)
+{
+    wxMutexLocker lock(m_lock);
+    return m_open;
+}
+
+void CameraFrameRing::Push(usImage& img)
+{
+    wxMutexLocker lock(m_lock);
+
+    if (!m_open)
+        return;
+
+    if (m_count == CAPACITY)
+    {
+        m_head = (m_head + 1) % CAPACITY;
+        --m_count;
+        ++m_dropped;
+    }
+
+    // the frame's age is counted from here, so time spent waiting in the
+    // ring counts towards the max frame age
+    img.ImgCapturedUs = LatencyStats::Now();
+
+    if (MoveFrame(m_frames[(m_head + m_count) % CAPACITY], img))
+        return;
+
+    ++m_count;
+    m_frameReady.Signal();
+}
+
+bool CameraFrameRing::Pop(usImage& img, int waitMs)
+{
+    wxMutexLocker lock(m_lock);
+
+    if (m_count == 0 && m_open)
+        m_frameReady.WaitTimeout(waitMs);
+
+    if (m_count == 0)
+        return true;
+
+    // latest wins: the older frames are as stale as a dropped frame
+    bool err = MoveFrame(img, m_frames[(m_head + m_count - 1) % CAPACITY]);
+    m_dropped += m_count - 1;
+    m_head = m_count = 0;
+
+    return err;
+}
+
+unsigned int CameraFrameRing::Dropped(void)
+{
+    wxMutexLocker lock(m_lock);
+    return m_dropped;
+}
+
 static int CompareNoCase(const wxString& first, const wxString& second)
 {
     return first.CmpNoCase(second);
@@ -319,6 +423,9 @@ wxArrayString GuideCamera::List(void)
 #if defined (SIMULATOR)
     CameraList.Add(_T("Simulator"));
 #endif
+#if defined (REPLAY_CAMERA)
+    CameraList.Add(_T("Replay"));
+#endif
 
 #if defined (NEB_SBIG)
     CameraList.Add(_T("Guide chip on SBIG cam in Nebulosity"));
@@ -356,6 +463,11 @@ GuideCamera *GuideCamera::Factory(const wxString& choice)
         else if (choice.Find(_T("Simulator")) + 1) {
             pReturn = new Camera_SimClass();
         }
+#if defined (REPLAY_CAMERA)
+        else if (choice == _T("Replay")) {
+            pReturn = new Camera_ReplayClass();
+        }
+#endif
 #if defined (SAC42)
         else if (choice.Find(_T("SAC4-2")) + 1) {
             pReturn = new Camera_SAC42Class();
@@ -952,9 +1064,10 @@ void GuideCamera::AddDark(usImage *dark)
             delete prior;
         }
 
-    } // lock scope
+        // the map is also read by SelectDark
+        Darks[expdur] = dark;
 
-    Darks[expdur] = dark;
+    } // lock scope
 }
 
 void GuideCamera::SelectDark(int exposureDuration)
@@ -1012,6 +1125,8 @@ void GuideCamera::SubtractDark(usImage& img)
 
     wxCriticalSectionLocker lck(DarkFrameLock);
 
+    wxLongLong_t const start = LatencyStats::Now();
+
     if (CurrentDefectMap)
     {
         RemoveDefects(img, *CurrentDefectMap);
@@ -1020,6 +1135,13 @@ void GuideCamera::SubtractDark(usImage& img)
     {
         Subtract(img, *CurrentDarkFrame);
     }
+    else
+    {
+        return;
+    }
+
+    img.ImgDarkUs = LatencyStats::Now() - start;
+    CycleStats.AddSample(STAGE_DARK, img.ImgDarkUs);
 }
 
 void GuideCamera::DisconnectWithAlert(CaptureFailType type)
@@ -1065,6 +1187,47 @@ void GuideCamera::InitCapture()
 {
 }
 
+bool GuideCamera::HasStreaming(void)
+{
+    return false;
+}
+
+bool GuideCamera::StartStream(int duration, int captureOptions, const wxRect& subframe)
+{
+    return true;
+}
+
+void GuideCamera::StopStream(void)
+{
+}
+
+// Called on the worker thread in place of Capture while the camera is
+// streaming. Waits for the camera's next frame, up to the exposure duration
+// plus the camera timeout, checking for a stop request as it waits.
+bool GuideCamera::NextFrame(int duration, usImage& img)
+{
+    enum { POLL_MS = 100 };
+
+    wxStopWatch swatch;
+    long const timeout = duration + GetTimeoutMs();
+
+    while (m_streamFrames.Pop(img, POLL_MS))
+    {
+        if (!m_streamFrames.IsOpen() || WorkerThread::InterruptRequested())
+            return true;
+
+        if (swatch.Time() > timeout)
+        {
+            Debug.AddLine("NextFrame: no frame from the camera after %ld ms", swatch.Time());
+            StopStream();
+            DisconnectWithAlert(CAPT_FAIL_TIMEOUT);
+            return true;
+        }
+    }
+
+    return false;
+}
+
 bool GuideCamera::ST4HasGuideOutput(void)
 {
     return m_hasGuideOutput;
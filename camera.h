@@ -81,6 +81,39 @@ enum CaptureOptionBits
     CAPTURE_BPM_REVIEW = CAPTURE_SUBTRACT_DARK,
 };
 
+// Frames delivered by a camera in streaming mode. The camera's capture thread
+// pushes frames as they arrive, stamping the time of arrival, and the worker
+// thread takes the newest one; older frames still waiting are dropped, so
+// guiding never runs behind the camera. Frames are moved in and out by
+// swapping pixel buffers, not copied.
+class CameraFrameRing
+{
+    enum { CAPACITY = 4 };
+
+    wxMutex m_lock;
+    wxCondition m_frameReady;
+    usImage m_frames[CAPACITY];
+    unsigned int m_head;        // oldest frame
+    unsigned int m_count;
+    unsigned int m_dropped;     // frames replaced by a newer one before they were taken
+    bool m_open;
+
+public:
+    CameraFrameRing(void);
+
+    void Open(void);
+    void Close(void);
+    void Clear(void);
+    bool IsOpen(void);
+
+    // takes the pixels of img, leaving img with a buffer of the same size
+    void Push(usImage& img);
+    // wait up to waitMs for a frame and take the newest; returns true if
+    // there was none
+    bool Pop(usImage& img, int waitMs);
+    unsigned int Dropped(void);
+};
+
 class GuideCamera :  public wxMessageBoxProxy, public OnboardST4
 {
     friend class CameraConfigDialogPane;
@@ -126,6 +159,17 @@ public:
     virtual bool    Disconnect() = 0;               // Disconnects, unloading any DLLs loaded by Connect
     virtual void    InitCapture();                  // Gets run at the start of any loop (e.g., reset stream, set gain, etc).
 
+    // Streaming (video mode) capture, for cameras that can deliver frames
+    // continuously. StartStream starts the stream, or changes the settings
+    // of the running stream: a new subframe applies from the next frame,
+    // a new duration or options discard the frames already taken. The
+    // camera pushes its frames into m_streamFrames; NextFrame waits for the
+    // newest one. All return true on error.
+    virtual bool    HasStreaming(void);
+    virtual bool    StartStream(int duration, int captureOptions, const wxRect& subframe);
+    virtual void    StopStream(void);
+    bool            NextFrame(int duration, usImage& img);
+
     virtual bool    ST4HasGuideOutput(void);
     virtual bool    ST4HostConnected(void);
     virtual bool    ST4HasNonGuiMove(void);
@@ -161,6 +205,8 @@ protected:
     };
     void DisconnectWithAlert(CaptureFailType type);
     void DisconnectWithAlert(const wxString& msg);
+
+    CameraFrameRing m_streamFrames;
 };
 
 inline int GuideCamera::GetTimeoutMs(void) const
@@ -62,6 +62,7 @@
 # define MEADE_DSI
 # define STARFISH
 # define SIMULATOR
+# define REPLAY_CAMERA
 # define SXV
 # define ATIK_GEN3
 # define INOVA_PLC
@@ -92,6 +93,7 @@
 # define MEADE_DSI
 # define STARFISH
 # define SIMULATOR
+# define REPLAY_CAMERA
 # define SXV
 # define OPENSSAG
 # define KWIQGUIDER
@@ -99,6 +101,7 @@
 
 #elif defined (__LINUX__)
 # define SIMULATOR
+# define REPLAY_CAMERA
 # define CAM_QHY5
 # define INDI_CAMERA
 # define ZWO_ASI
@@ -0,0 +1,837 @@
+/*
+ *  centroid_benchmark.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2016 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "phd.h"
+
+#include <wx/stopwatch.h>
+#include <wx/tokenzr.h>
+
+// The benchmark is deterministic: the random numbers come from a fixed-seed
+// generator so that runs on different builds see the same images and their
+// results can be compared directly.
+
+enum
+{
+    FRAME_SIZE = 64,            // Star::Find test frame
+    SEARCH_REGION = 15,
+    TRIALS = 200,
+    AUTOFIND_WIDTH = 640,
+    AUTOFIND_HEIGHT = 480,
+    AUTOFIND_STARS = 20,
+    AUTOFIND_TRIALS = 20,
+    SUPERSAMPLE = 5,
+    GUIDE_STEPS = 200000,
+    ALGORITHM_STEPS = 100000,
+    ALGORITHM_HISTORY = 10,     // history size of the reference guide algorithms
+};
+
+static const double Background = 1000.0;
+static const double ReadNoise = 10.0;
+static const double GradientPerPx = 2.0;
+static const double HotPixelFraction = 0.001;
+static const double HotPixelGain = 2.0;     // hot pixel level relative to the star peak
+static const double MoffatBeta = 2.5;
+
+// Regression limits against a baseline report. The images are the same on
+// every run, so detection and accuracy only change when the code does;
+// the timings are noisier and get more room.
+static const double MaxDetectDrop = 2.0;       // percentage points
+static const double MaxRmsGrowth = 1.1;
+static const double RmsSlackPx = 0.005;
+static const double MaxSlowdown = 1.5;
+
+class BenchRandom
+{
+    unsigned int m_state;
+    bool m_haveSpare;
+    double m_spare;
+
+public:
+    BenchRandom(unsigned int seed) : m_state(seed), m_haveSpare(false), m_spare(0.0) { }
+
+    // xorshift32, uniform in [0, 1)
+    double Uniform(void)
+    {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return (double) m_state / 4294967296.0;
+    }
+
+    double Gaussian(void)
+    {
+        if (m_haveSpare)
+        {
+            m_haveSpare = false;
+            return m_spare;
+        }
+        double u, v, s;
+        do
+        {
+            u = 2.0 * Uniform() - 1.0;
+            v = 2.0 * Uniform() - 1.0;
+            s = u * u + v * v;
+        } while (s >= 1.0 || s == 0.0);
+        double f = sqrt(-2.0 * log(s) / s);
+        m_spare = v * f;
+        m_haveSpare = true;
+        return u * f;
+    }
+};
+
+enum Condition
+{
+    COND_CLEAN,
+    COND_HOT_PIXELS,
+    COND_GRADIENT,
+};
+
+static const char *ConditionName(Condition cond)
+{
+    switch (cond)
+    {
+    case COND_CLEAN:      return "clean";
+    case COND_HOT_PIXELS: return "hotpix";
+    case COND_GRADIENT:   return "gradient";
+    }
+    return "";
+}
+
+struct SyntheticStar
+{
+    double x;
+    double y;
+    double sigma;       // Gaussian sigma; Moffat stars have the same FWHM
+    bool moffat;
+    double amplitude;   // peak above background
+};
+
+// One row of the report. key is the row's leading label columns, exactly
+// as written, which is how the row is found again in a baseline report.
+struct BenchResult
+{
+    wxString key;
+    double detect;      // percent, < 0 if not measured
+    double rms;         // pixels, < 0 if not measured
+    double ns;
+
+    BenchResult(const wxString& key_, double detect_, double rms_, double ns_)
+        : key(key_), detect(detect_), rms(rms_), ns(ns_) { }
+};
+
+typedef std::vector<BenchResult> BenchResults;
+
+static double StarProfile(const SyntheticStar& star, double dx, double dy)
+{
+    double r2 = dx * dx + dy * dy;
+    if (!star.moffat)
+        return exp(-0.5 * r2 / (star.sigma * star.sigma));
+    double alpha = star.sigma * sqrt(2.0 * log(2.0)) / sqrt(pow(2.0, 1.0 / MoffatBeta) - 1.0);
+    return pow(1.0 + r2 / (alpha * alpha), -MoffatBeta);
+}
+
+// background and noise; noise has a Poisson component from the signal
+static void RenderBackground(usImage& img, Condition cond)
+{
+    for (int y = 0; y < img.Size.GetHeight(); y++)
+    {
+        for (int x = 0; x < img.Size.GetWidth(); x++)
+        {
+            double v = Background;
+            if (cond == COND_GRADIENT)
+                v += GradientPerPx * (x + 0.5 * y);
+            img.Pixel(x, y) = (unsigned short) v;
+        }
+    }
+}
+
+static void RenderStar(usImage& img, const SyntheticStar& star)
+{
+    // average the profile over each pixel
+    int r = (int) ceil(8.0 * star.sigma) + 2;
+    int x0 = wxMax(0, (int) star.x - r), x1 = wxMin(img.Size.GetWidth() - 1, (int) star.x + r);
+    int y0 = wxMax(0, (int) star.y - r), y1 = wxMin(img.Size.GetHeight() - 1, (int) star.y + r);
+
+    for (int y = y0; y <= y1; y++)
+    {
+        for (int x = x0; x <= x1; x++)
+        {
+            double sum = 0.0;
+            for (int j = 0; j < SUPERSAMPLE; j++)
+                for (int i = 0; i < SUPERSAMPLE; i++)
+                    sum += StarProfile(star,
+                        x - 0.5 + (i + 0.5) / SUPERSAMPLE - star.x,
+                        y - 0.5 + (j + 0.5) / SUPERSAMPLE - star.y);
+            double v = img.Pixel(x, y) + star.amplitude * sum / (SUPERSAMPLE * SUPERSAMPLE);
+            img.Pixel(x, y) = (unsigned short) wxMin(v, 65535.0);
+        }
+    }
+}
+
+static void AddNoise(usImage& img, Condition cond, double hotLevel, BenchRandom& rng)
+{
+    for (int i = 0; i < img.NPixels; i++)
+    {
+        double v = img.ImageData[i];
+        v += rng.Gaussian() * sqrt(ReadNoise * ReadNoise + v);
+        if (cond == COND_HOT_PIXELS && rng.Uniform() < HotPixelFraction)
+            v = hotLevel;
+        img.ImageData[i] = (unsigned short) wxMax(0.0, wxMin(v, 65535.0));
+    }
+}
+
+static double NoiseSigma(void)
+{
+    return sqrt(ReadNoise * ReadNoise + Background);
+}
+
+struct FindMethod
+{
+    const char *name;
+    Star::FindMode mode;
+    PsfModel psfModel;
+};
+
+static const FindMethod s_methods[] =
+{
+    { "centroid",   Star::FIND_CENTROID, PSF_GAUSSIAN },
+    { "peak",       Star::FIND_PEAK,     PSF_GAUSSIAN },
+    { "psf-gauss",  Star::FIND_PSF_FIT,  PSF_GAUSSIAN },
+    { "psf-moffat", Star::FIND_PSF_FIT,  PSF_MOFFAT },
+};
+
+struct FindStats
+{
+    unsigned int trials;
+    unsigned int found;
+    double sumDx, sumDy, sumSq;
+    wxLongLong usec;
+
+    FindStats() : trials(0), found(0), sumDx(0.0), sumDy(0.0), sumSq(0.0), usec(0) { }
+};
+
+static void BenchFind(wxFFile& out, BenchResults& results, bool moffat, double sigma, double snr, Condition cond)
+{
+    FindStats stats[WXSIZEOF(s_methods)];
+    BenchRandom rng(12345);
+    usImage img;
+    img.Init(FRAME_SIZE, FRAME_SIZE);
+
+    for (int t = 0; t < TRIALS; t++)
+    {
+        SyntheticStar star;
+        star.x = FRAME_SIZE / 2 + rng.Uniform() - 0.5;
+        star.y = FRAME_SIZE / 2 + rng.Uniform() - 0.5;
+        star.sigma = sigma;
+        star.moffat = moffat;
+        star.amplitude = snr * NoiseSigma();
+
+        RenderBackground(img, cond);
+        RenderStar(img, star);
+        double hotLevel = Background + HotPixelGain * star.amplitude;
+        AddNoise(img, cond, hotLevel, rng);
+        if (cond == COND_HOT_PIXELS)
+        {
+            // make sure there is one in the search region
+            img.Pixel(FRAME_SIZE / 2 + 6, FRAME_SIZE / 2 - 5) = (unsigned short) hotLevel;
+        }
+
+        // start the search a little off the star, as in guiding
+        int startX = FRAME_SIZE / 2 + (rng.Uniform() < 0.5 ? -2 : 2);
+        int startY = FRAME_SIZE / 2 + (rng.Uniform() < 0.5 ? -2 : 2);
+
+        for (unsigned int m = 0; m < WXSIZEOF(s_methods); m++)
+        {
+            Star::SetPsfModel(s_methods[m].psfModel);
+            Star s;
+
+            wxStopWatch sw;
+            bool found = s.Find(&img, SEARCH_REGION, startX, startY, s_methods[m].mode);
+            stats[m].usec += sw.TimeInMicro();
+
+            stats[m].trials++;
+            if (found && s.Distance(PHD_Point(star.x, star.y)) < 2.0)
+            {
+                double dx = s.X - star.x, dy = s.Y - star.y;
+                stats[m].found++;
+                stats[m].sumDx += dx;
+                stats[m].sumDy += dy;
+                stats[m].sumSq += dx * dx + dy * dy;
+            }
+        }
+    }
+
+    for (unsigned int m = 0; m < WXSIZEOF(s_methods); m++)
+    {
+        const FindStats& st = stats[m];
+        double n = wxMax(st.found, 1U);
+        BenchResult r(wxString::Format("%-7s %5.2f %5.0f %-9s %-11s ",
+            moffat ? "moffat" : "gauss", sigma, snr, ConditionName(cond), s_methods[m].name),
+            100.0 * st.found / st.trials, sqrt(st.sumSq / n), st.usec.ToDouble() * 1000.0 / st.trials);
+        out.Write(r.key + wxString::Format("%6.1f%% %8.4f %8.4f %8.4f %9.0f\n",
+            r.detect, r.rms, st.sumDx / n, st.sumDy / n, r.ns));
+        results.push_back(r);
+    }
+}
+
+static void BenchAutoFind(wxFFile& out, BenchResults& results, double snr, Condition cond)
+{
+    BenchRandom rng(54321);
+    usImage img;
+    img.Init(AUTOFIND_WIDTH, AUTOFIND_HEIGHT);
+
+    unsigned int hits = 0;
+    wxLongLong usec = 0;
+
+    for (int t = 0; t < AUTOFIND_TRIALS; t++)
+    {
+        RenderBackground(img, cond);
+
+        std::vector<SyntheticStar> stars;
+        for (int i = 0; i < AUTOFIND_STARS; i++)
+        {
+            SyntheticStar star;
+            star.x = 50 + rng.Uniform() * (AUTOFIND_WIDTH - 100);
+            star.y = 50 + rng.Uniform() * (AUTOFIND_HEIGHT - 100);
+            star.sigma = 1.0 + rng.Uniform();
+            star.moffat = rng.Uniform() < 0.5;
+            star.amplitude = snr * NoiseSigma() * (0.5 + rng.Uniform());
+            RenderStar(img, star);
+            stars.push_back(star);
+        }
+        AddNoise(img, cond, Background + HotPixelGain * snr * NoiseSigma(), rng);
+
+        Star s;
+        wxStopWatch sw;
+        bool found = s.AutoFind(img, 0, SEARCH_REGION);
+        usec += sw.TimeInMicro();
+
+        if (found)
+        {
+            for (unsigned int i = 0; i < stars.size(); i++)
+            {
+                if (s.Distance(PHD_Point(stars[i].x, stars[i].y)) < 1.5)
+                {
+                    hits++;
+                    break;
+                }
+            }
+        }
+    }
+
+    BenchResult r(wxString::Format("AutoFind %dx%d %5.0f %-9s ",
+        AUTOFIND_WIDTH, AUTOFIND_HEIGHT, snr, ConditionName(cond)),
+        100.0 * hits / AUTOFIND_TRIALS, -1.0, usec.ToDouble() * 1000.0 / AUTOFIND_TRIALS);
+    out.Write(r.key + wxString::Format("%6.1f%% %12.0f\n", r.detect, r.ns));
+    results.push_back(r);
+}
+
+// Guide algorithm check. Lowpass, Lowpass2 and ResistSwitch keep their
+// history in fixed ring buffers; the reference versions below are the
+// ArrayOfDbl implementations they replaced. Both are fed the same error
+// sequence and must return exactly the same corrections.
+
+static const double CheckMinMove = 0.2;
+static const double CheckSlopeWeight = 5.0;
+static const double CheckAggressiveness = 80.0;    // Lowpass2, percent
+static const double CheckAggression = 0.7;         // ResistSwitch
+
+// The algorithms only use their mount for the path of their settings,
+// which are written for the check and removed from the profile after it.
+class BenchMount : public Mount
+{
+public:
+    MOVE_RESULT Move(GUIDE_DIRECTION direction, int amount, bool normalMove, MoveResultInfo *moveResultInfo) { return MOVE_ERROR; }
+    MOVE_RESULT CalibrationMove(GUIDE_DIRECTION direction, int duration) { return MOVE_ERROR; }
+    int CalibrationMoveSize(void) { return 0; }
+    int CalibrationTotDistance(void) { return 0; }
+    bool BeginCalibration(const PHD_Point& currentLocation) { return true; }
+    bool UpdateCalibrationState(const PHD_Point& currentLocation) { return true; }
+    bool GuidingCeases(void) { return false; }
+    ConfigDialogPane *GetConfigDialogPane(wxWindow *pParent) { return NULL; }
+    wxString GetMountClassName(void) const { return "benchmark"; }
+};
+
+class RefLowpass
+{
+    ArrayOfDbl m_history;
+    double m_minMove;
+    double m_slopeWeight;
+
+public:
+    RefLowpass(double minMove, double slopeWeight) : m_minMove(minMove), m_slopeWeight(slopeWeight)
+    {
+        while (m_history.GetCount() < ALGORITHM_HISTORY)
+            m_history.Add(0.0);
+    }
+
+    double result(double input)
+    {
+        m_history.Add(input);
+
+        ArrayOfDbl sortedHistory(m_history);
+        sortedHistory.Sort(dbl_sort_func);
+
+        m_history.RemoveAt(0);
+
+        double median = sortedHistory[sortedHistory.GetCount()/2];
+        double dReturn = median + m_slopeWeight * CalcSlope(m_history);
+
+        if (fabs(dReturn) > fabs(input))
+            dReturn = input;
+        if (fabs(input) < m_minMove)
+            dReturn = 0.0;
+
+        return dReturn;
+    }
+};
+
+class RefLowpass2
+{
+    ArrayOfDbl m_history;
+    double m_minMove;
+    double m_aggressiveness;
+    int m_rejects;
+
+    void reset(void)
+    {
+        m_history.Empty();
+        m_rejects = 0;
+    }
+
+public:
+    RefLowpass2(double minMove, double aggressiveness) : m_minMove(minMove), m_aggressiveness(aggressiveness)
+    {
+        reset();
+    }
+
+    double result(double input)
+    {
+        m_history.Add(input);
+        unsigned int numpts = m_history.GetCount();
+        double dReturn;
+        double attenuation = m_aggressiveness / 100.;
+
+        if (numpts < 4)
+            dReturn = input * attenuation;
+        else
+        {
+            if (fabs(input) > 4.0 * m_minMove)
+            {
+                dReturn = input * attenuation;
+                reset();
+                numpts = 0;
+            }
+            else
+                dReturn = CalcSlope(m_history) * (double) numpts * attenuation;
+        }
+
+        if (numpts == ALGORITHM_HISTORY)
+            m_history.RemoveAt(0);
+
+        if (fabs(dReturn) > fabs(input))
+        {
+            dReturn = input * attenuation;
+            m_rejects++;
+            if (m_rejects > 3)
+                reset();
+        }
+        else
+            m_rejects = 0;
+        if (fabs(input) < m_minMove)
+            dReturn = 0.0;
+
+        return dReturn;
+    }
+};
+
+static int BenchSign(double x)
+{
+    return x > 0.0 ? 1 : x < 0.0 ? -1 : 0;
+}
+
+// The ResistSwitch of the array history version, which also reported a
+// vetoed move by throwing, as the guide step path used to
+class RefResistSwitch
+{
+    ArrayOfDbl m_history;
+    double m_minMove;
+    double m_aggression;
+    bool m_fastSwitchEnabled;
+    int m_currentSide;
+
+public:
+    RefResistSwitch(double minMove, double aggression, bool fastSwitch)
+        : m_minMove(minMove), m_aggression(aggression), m_fastSwitchEnabled(fastSwitch), m_currentSide(0)
+    {
+        while (m_history.GetCount() < ALGORITHM_HISTORY)
+            m_history.Add(0.0);
+    }
+
+    double result(double input)
+    {
+        double dReturn = input;
+
+        m_history.Add(input);
+        m_history.RemoveAt(0);
+
+        try
+        {
+            if (fabs(input) < m_minMove)
+            {
+                throw THROW_INFO("input < m_minMove");
+            }
+
+            if (m_fastSwitchEnabled)
+            {
+                double thresh = 3.0 * m_minMove;
+                if (BenchSign(input) != m_currentSide && fabs(input) > thresh)
+                {
+                    Debug.Write(wxString::Format("resist switch: large excursion: input %.2f thresh %.2f direction from %d to %d\n", input, thresh, m_currentSide, BenchSign(input)));
+                    // force switch
+                    m_currentSide = 0;
+                    unsigned int i;
+                    for (i = 0; i < ALGORITHM_HISTORY - 3; i++)
+                        m_history[i] = 0.0;
+                    for (; i < ALGORITHM_HISTORY; i++)
+                        m_history[i] = input;
+                }
+            }
+
+            int decHistory = 0;
+
+            for (unsigned int i = 0; i < m_history.GetCount(); i++)
+            {
+                if (fabs(m_history[i]) > m_minMove)
+                {
+                    decHistory += BenchSign(m_history[i]);
+                }
+            }
+
+            if (m_currentSide == 0 || BenchSign(m_currentSide) == -BenchSign(decHistory))
+            {
+                if (abs(decHistory) < 3)
+                {
+                    throw THROW_INFO("not compelling enough");
+                }
+
+                double oldest = 0.0;
+                double newest = 0.0;
+
+                for (int i = 0; i < 3; i++)
+                {
+                    oldest += m_history[i];
+                    newest += m_history[m_history.GetCount() - (i + 1)];
+                }
+
+                if (fabs(newest) <= fabs(oldest))
+                {
+                    throw THROW_INFO("Not getting worse");
+                }
+
+                Debug.Write(wxString::Format("switching direction from %d to %d - decHistory=%d oldest=%.2f newest=%.2f\n", m_currentSide, BenchSign(decHistory), decHistory, oldest, newest));
+
+                m_currentSide = BenchSign(decHistory);
+            }
+
+            if (m_currentSide != BenchSign(input))
+            {
+                throw THROW_INFO("must have overshot -- vetoing move");
+            }
+        }
+        catch (const wxString& Msg)
+        {
+            POSSIBLY_UNUSED(Msg);
+            dReturn = 0.0;
+        }
+
+        Debug.Write(wxString::Format("GuideAlgorithmResistSwitch::Result() returns %.2f from input %.2f\n", dReturn, input));
+
+        return dReturn * m_aggression;
+    }
+};
+
+// Guide errors with a slow periodic error, seeing noise, and now and then
+// a large excursion, so the outlier, reject and fast switch paths all run.
+static std::vector<double> GuideErrorSequence(void)
+{
+    BenchRandom rng(13579);
+    std::vector<double> errors(ALGORITHM_STEPS);
+
+    for (unsigned int i = 0; i < errors.size(); i++)
+    {
+        double e = 0.5 * sin(i * 0.01) + 0.3 * rng.Gaussian();
+        if (rng.Uniform() < 0.002)
+            e += rng.Uniform() < 0.5 ? -3.0 : 3.0;
+        errors[i] = e;
+    }
+
+    return errors;
+}
+
+// writes the settings the algorithms under test read, returns the profile
+// group to remove afterwards
+static wxString WriteCheckSettings(const BenchMount& mount)
+{
+    wxString group = "/" + mount.GetMountClassName();
+    wxString path = group + "/GuideAlgorithm/X/";
+    pConfig->Profile.DeleteGroup(group);
+    pConfig->Profile.SetDouble(path + "Lowpass/minMove", CheckMinMove);
+    pConfig->Profile.SetDouble(path + "Lowpass/SlopeWeight", CheckSlopeWeight);
+    pConfig->Profile.SetDouble(path + "Lowpass2/minMove", CheckMinMove);
+    pConfig->Profile.SetDouble(path + "Lowpass2/Aggressiveness", CheckAggressiveness);
+    pConfig->Profile.SetDouble(path + "ResistSwitch/minMove", CheckMinMove);
+    pConfig->Profile.SetDouble(path + "ResistSwitch/aggression", CheckAggression);
+    pConfig->Profile.SetBoolean(path + "ResistSwitch/fastSwitch", true);
+    return group;
+}
+
+template <typename ALGO, typename REF>
+static bool CheckGuideAlgorithm(wxFFile& out, const char *name, ALGO& algo, REF& ref, const std::vector<double>& errors)
+{
+    unsigned int mismatches = 0;
+    unsigned int moves = 0;
+
+    for (unsigned int i = 0; i < errors.size(); i++)
+    {
+        double r = algo.result(errors[i]);
+        if (r != ref.result(errors[i]))
+            mismatches++;
+        if (r != 0.0)
+            moves++;
+    }
+
+    out.Write(wxString::Format("%-13s %9u %9u %10u  %s\n", name, (unsigned int) errors.size(), moves, mismatches,
+        mismatches ? "FAILED" : "ok"));
+
+    return mismatches != 0;
+}
+
+static bool CheckGuideAlgorithms(wxFFile& out)
+{
+    std::vector<double> errors = GuideErrorSequence();
+    BenchMount mount;
+    bool failed = false;
+
+    wxString group = WriteCheckSettings(mount);
+
+    out.Write("\nalgorithm         steps     moves mismatches  (ring buffer vs. array implementation)\n");
+
+    GuideAlgorithmLowpass lowpass(&mount, GUIDE_X);
+    RefLowpass refLowpass(CheckMinMove, CheckSlopeWeight);
+    failed |= CheckGuideAlgorithm(out, "lowpass", lowpass, refLowpass, errors);
+
+    GuideAlgorithmLowpass2 lowpass2(&mount, GUIDE_X);
+    RefLowpass2 refLowpass2(CheckMinMove, CheckAggressiveness);
+    failed |= CheckGuideAlgorithm(out, "lowpass2", lowpass2, refLowpass2, errors);
+
+    GuideAlgorithmResistSwitch resistSwitch(&mount, GUIDE_X);
+    RefResistSwitch refResistSwitch(CheckMinMove, CheckAggression, true);
+    failed |= CheckGuideAlgorithm(out, "resist switch", resistSwitch, refResistSwitch, errors);
+
+    pConfig->Profile.DeleteGroup(group);
+
+    return failed;
+}
+
+// Steady-state guide steps. Most steps while guiding well are vetoed
+// (error below the minimum move, or an overshoot). This times the
+// ResistSwitch algorithm that makes those decisions against its array
+// history version, which reported each veto by throwing a wxString.
+
+static const double SeeingSigma = 0.25;     // steady-state error, pixels
+
+template <typename ALGO>
+static void BenchGuideStep(wxFFile& out, BenchResults& results, const char *name, ALGO& algo, const std::vector<double>& errors)
+{
+    unsigned int moves = 0;
+    wxStopWatch sw;
+    for (unsigned int i = 0; i < errors.size(); i++)
+    {
+        if (algo.result(errors[i]) != 0.0)
+            moves++;
+    }
+    wxLongLong usec = sw.TimeInMicro();
+
+    // the veto rate is checked exactly by CheckGuideAlgorithms, only the
+    // speed is compared with the baseline
+    BenchResult r(wxString::Format("%-19s ", name), -1.0, -1.0, usec.ToDouble() * 1000.0 / errors.size());
+    out.Write(r.key + wxString::Format("%7.1f%% %9.1f\n",
+        100.0 * (errors.size() - moves) / errors.size(), r.ns));
+    results.push_back(r);
+}
+
+static void BenchGuideSteps(wxFFile& out, BenchResults& results)
+{
+    BenchRandom rng(24680);
+    std::vector<double> errors(GUIDE_STEPS);
+    for (unsigned int i = 0; i < errors.size(); i++)
+        errors[i] = SeeingSigma * rng.Gaussian();
+
+    BenchMount mount;
+    wxString group = WriteCheckSettings(mount);
+
+    out.Write(wxString::Format("\nresist switch       vetoed    ns/step  (%d steps, error sigma %.2f px, min move %.2f px)\n",
+        GUIDE_STEPS, SeeingSigma, CheckMinMove));
+
+    RefResistSwitch refResistSwitch(CheckMinMove, CheckAggression, true);
+    BenchGuideStep(out, results, "array, throw", refResistSwitch, errors);
+
+    GuideAlgorithmResistSwitch resistSwitch(&mount, GUIDE_X);
+    BenchGuideStep(out, results, "ring buffer, return", resistSwitch, errors);
+
+    pConfig->Profile.DeleteGroup(group);
+}
+
+// Parses the measurements that follow key on a baseline report line:
+// detection (if measured) is the first column, rms (if measured) the
+// second and the time per call is always the last.
+static bool ParseBaselineRow(const wxString& rest, const BenchResult& cur, double *detect, double *rms, double *ns)
+{
+    wxArrayString cols = wxStringTokenize(rest, " \t\r\n", wxTOKEN_STRTOK);
+    if (cols.IsEmpty() || !cols.Last().ToCDouble(ns))
+        return false;
+    if (cur.detect >= 0.0)
+    {
+        wxString s(cols[0]);
+        if (!s.EndsWith("%", &s) || !s.ToCDouble(detect))
+            return false;
+    }
+    if (cur.rms >= 0.0 && (cols.GetCount() < 2 || !cols[1].ToCDouble(rms)))
+        return false;
+    return true;
+}
+
+// Compares the results with a report from an earlier run and lists the rows
+// that got worse. Returns true if the baseline can't be read or any row
+// regressed.
+static bool CompareBaseline(wxFFile& out, const wxString& baselineFile, const BenchResults& results)
+{
+    out.Write(wxString::Format("\nregressions against %s\n", baselineFile));
+
+    wxTextFile baseline;
+    if (!wxFileExists(baselineFile) || !baseline.Open(baselineFile))
+    {
+        out.Write("FAILED: cannot read the baseline report\n");
+        return true;
+    }
+
+    unsigned int compared = 0;
+    unsigned int regressions = 0;
+
+    for (unsigned int i = 0; i < results.size(); i++)
+    {
+        const BenchResult& cur = results[i];
+
+        for (size_t n = 0; n < baseline.GetLineCount(); n++)
+        {
+            wxString rest;
+            if (!baseline[n].StartsWith(cur.key, &rest))
+                continue;
+
+            double detect = 0.0, rms = 0.0, ns = 0.0;
+            if (!ParseBaselineRow(rest, cur, &detect, &rms, &ns))
+                break;
+
+            compared++;
+
+            wxString why;
+            if (cur.detect >= 0.0 && cur.detect < detect - MaxDetectDrop)
+                why += wxString::Format(" detect %.1f%% -> %.1f%%", detect, cur.detect);
+            if (cur.rms >= 0.0 && cur.rms > rms * MaxRmsGrowth + RmsSlackPx)
+                why += wxString::Format(" rms %.4f -> %.4f px", rms, cur.rms);
+            if (cur.ns > ns * MaxSlowdown)
+                why += wxString::Format(" %.0f -> %.0f ns", ns, cur.ns);
+
+            if (!why.IsEmpty())
+            {
+                out.Write("FAILED " + cur.key + why + "\n");
+                regressions++;
+            }
+            break;
+        }
+    }
+
+    out.Write(wxString::Format("%u of %u rows compared, %u regressed (limits: detect -%.1f points, rms x%.2f + %.3f px, time x%.1f)\n",
+        compared, (unsigned int) results.size(), regressions, MaxDetectDrop, MaxRmsGrowth, RmsSlackPx, MaxSlowdown));
+
+    // a baseline that matches none of the rows is the wrong file, not a pass
+    return regressions > 0 || compared == 0;
+}
+
+bool RunCentroidBenchmark(const wxString& fileName, const wxString& baselineFile)
+{
+    wxFFile out;
+    if (!out.Open(fileName, "w"))
+        return true;
+
+    // logging every Find call would swamp the timings
+    bool debugEnabled = Debug.IsEnabled();
+    Debug.Enable(false);
+    PsfModel prevModel = Star::GetPsfModel();
+
+    out.Write(wxString::Format("PHD2 %s centroid benchmark, %d trials per row, search region %d\n\n",
+        FULLVER, TRIALS, SEARCH_REGION));
+    out.Write("profile sigma   snr cond      method      detect   rms_px   bias_x   bias_y   ns/call\n");
+
+    BenchResults results;
+
+    static const double sigmas[] = { 0.6, 1.0, 2.0 };
+    static const double snrs[] = { 10.0, 50.0 };
+    static const Condition conds[] = { COND_CLEAN, COND_HOT_PIXELS, COND_GRADIENT };
+
+    for (int moffat = 0; moffat < 2; moffat++)
+        for (unsigned int i = 0; i < WXSIZEOF(sigmas); i++)
+            for (unsigned int j = 0; j < WXSIZEOF(snrs); j++)
+                for (unsigned int k = 0; k < WXSIZEOF(conds); k++)
+                    BenchFind(out, results, moffat != 0, sigmas[i], snrs[j], conds[k]);
+
+    out.Write(wxString::Format("\nframe              snr cond      detect      ns/call  (%d stars, %d trials per row)\n",
+        AUTOFIND_STARS, AUTOFIND_TRIALS));
+
+    for (unsigned int j = 0; j < WXSIZEOF(snrs); j++)
+        for (unsigned int k = 0; k < WXSIZEOF(conds); k++)
+            BenchAutoFind(out, results, snrs[j], conds[k]);
+
+    BenchGuideSteps(out, results);
+
+    bool failed = CheckGuideAlgorithms(out);
+
+    if (!baselineFile.IsEmpty() && CompareBaseline(out, baselineFile, results))
+        failed = true;
+
+    Star::SetPsfModel(prevModel);
+    Debug.Enable(debugEnabled);
+
+    return !out.Close() || failed;
+}
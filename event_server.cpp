@@ -786,6 +786,22 @@ static void get_app_state(JObj& response, const json_value *params)
     response << jrpc_result(state_name(st));
 }
 
+// latency percentiles in milliseconds for each stage of the guide cycle
+static void get_cycle_stats(JObj& response, const json_value *params)
+{
+    JObj rslt;
+    for (int i = 0; i < STAGE_COUNT; i++)
+    {
+        GuideCycleStage stage = (GuideCycleStage) i;
+        double p50, p95, p99;
+        unsigned int n = CycleStats.Stage(stage).GetPercentiles(&p50, &p95, &p99);
+        JObj t;
+        t << NV("samples", (int) n) << NV("p50", p50, 3) << NV("p95", p95, 3) << NV("p99", p99, 3);
+        rslt << NV(GuideCycleStats::StageName(stage), t);
+    }
+    response << jrpc_result(rslt);
+}
+
 static void get_lock_position(JObj& response, const json_value *params)
 {
     const PHD_Point& lockPos = pFrame->pGuider->LockPosition();
@@ -1267,6 +1283,7 @@ static bool handle_request(const wxSocketClient *cli, JObj& response, const json
         { "find_star", &find_star, },
         { "get_pixel_scale", &get_pixel_scale, },
         { "get_app_state", &get_app_state, },
+        { "get_cycle_stats", &get_cycle_stats, },
         { "flip_calibration", &flip_calibration, },
         { "get_lock_shift_enabled", &get_lock_shift_enabled, },
         { "set_lock_shift_enabled", &set_lock_shift_enabled, },
@@ -1601,10 +1618,10 @@ void EventServer::NotifyGuideStep(const GuideStepInfo& step)
     ev << NV("Frame", step.frameNumber)
        << NV("Time", step.time, 3)
        << NVMount(step.mount)
-       << NV("dx", step.cameraOffset->X, 3)
-       << NV("dy", step.cameraOffset->Y, 3)
-       << NV("RADistanceRaw", step.mountOffset->X, 3)
-       << NV("DECDistanceRaw", step.mountOffset->Y, 3)
+       << NV("dx", step.cameraOffset.X, 3)
+       << NV("dy", step.cameraOffset.Y, 3)
+       << NV("RADistanceRaw", step.mountOffset.X, 3)
+       << NV("DECDistanceRaw", step.mountOffset.Y, 3)
        << NV("RADistanceGuide", step.guideDistanceRA, 3)
        << NV("DECDistanceGuide", step.guideDistanceDec, 3);
 
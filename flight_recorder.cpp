@@ -0,0 +1,533 @@
+/*
+ *  flight_recorder.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2016 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "phd.h"
+
+#ifdef __WINDOWS__
+# include <wx/msw/wrapwin.h>
+#else
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+static const bool DefaultFlightRecorderEnabled = false;
+static const int DefaultFlightRecorderSizeMb = 64;
+static const int MinFlightRecorderSizeMb = 4;
+static const int MaxFlightRecorderSizeMb = 1024;
+
+enum
+{
+    EVENT_DUMP_FRAMES = 100,            // frames written when the star is lost or calibration fails
+    EVENT_DUMP_INTERVAL_MS = 60000,
+};
+
+static const char FLIGHT_RECORDER_MAGIC[8] = { 'P', 'H', 'D', '2', 'F', 'R', 'C', '1' };
+
+struct FlightRecorderHeader
+{
+    char magic[8];
+    unsigned int slotSize;
+    unsigned int slotCount;
+    unsigned int next;          // slot for the next frame
+    unsigned int count;         // slots in use
+    unsigned int reserved[2];
+};
+
+enum FlightRecorderSlotFlags
+{
+    SLOT_STAR_LOST   = 1 << 0,
+    SLOT_STAR_VALID  = 1 << 1,
+    SLOT_LOCK_VALID  = 1 << 2,
+};
+
+// followed by MAX_DIM * MAX_DIM pixels
+struct FlightRecorderSlot
+{
+    wxLongLong_t startMs;       // exposure start, UTC milliseconds
+    unsigned int frameNumber;
+    int exposure;               // milliseconds
+    int guiderState;
+    int flags;
+    int frameWidth;
+    int frameHeight;
+    int x;                      // region kept, in frame coordinates
+    int y;
+    int width;
+    int height;
+    double starX;
+    double starY;
+    double lockX;
+    double lockY;
+    double mass;
+    double snr;
+};
+
+static unsigned int SlotSize(void)
+{
+    return (sizeof(FlightRecorderSlot) + FlightRecorder::MAX_DIM * FlightRecorder::MAX_DIM * sizeof(unsigned short) + 7) & ~7U;
+}
+
+static unsigned short *SlotPixels(FlightRecorderSlot *slot)
+{
+    return reinterpret_cast<unsigned short *>(slot + 1);
+}
+
+FlightRecorder FlightRec;
+
+FlightRecorder::FlightRecorder(void)
+    : m_enabled(false),
+      m_sizeMb(DefaultFlightRecorderSizeMb),
+      m_instanceNumber(1),
+      m_mapSize(0),
+      m_map(0),
+#ifdef __WINDOWS__
+      m_file(0),
+      m_mapping(0),
+#else
+      m_fd(-1),
+#endif
+      m_lastEventDump(0)
+{
+}
+
+FlightRecorder::~FlightRecorder(void)
+{
+    Close();
+}
+
+FlightRecorderHeader *FlightRecorder::Header(void) const
+{
+    return reinterpret_cast<FlightRecorderHeader *>(m_map);
+}
+
+FlightRecorderSlot *FlightRecorder::Slot(unsigned int i) const
+{
+    return reinterpret_cast<FlightRecorderSlot *>(m_map + sizeof(FlightRecorderHeader) + (size_t) i * Header()->slotSize);
+}
+
+bool FlightRecorder::Map(size_t size)
+{
+#ifdef __WINDOWS__
+    m_file = ::CreateFileW(m_path.wc_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        m_file = 0;
+        return true;
+    }
+    m_mapping = ::CreateFileMappingW(m_file, NULL, PAGE_READWRITE, 0, (DWORD) size, NULL);
+    if (!m_mapping)
+    {
+        Unmap();
+        return true;
+    }
+    m_map = static_cast<char *>(::MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, size));
+    if (!m_map)
+    {
+        Unmap();
+        return true;
+    }
+#else
+    m_fd = open(m_path.fn_str(), O_RDWR | O_CREAT, 0644);
+    if (m_fd < 0)
+        return true;
+    struct stat st;
+    if (fstat(m_fd, &st) != 0 || ((size_t) st.st_size != size && ftruncate(m_fd, size) != 0))
+    {
+        Unmap();
+        return true;
+    }
+    void *p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (p == MAP_FAILED)
+    {
+        Unmap();
+        return true;
+    }
+    m_map = static_cast<char *>(p);
+#endif
+
+    m_mapSize = size;
+    return false;
+}
+
+void FlightRecorder::Unmap(void)
+{
+#ifdef __WINDOWS__
+    if (m_map)
+        ::UnmapViewOfFile(m_map);
+    if (m_mapping)
+        ::CloseHandle(m_mapping);
+    if (m_file)
+        ::CloseHandle(m_file);
+    m_mapping = 0;
+    m_file = 0;
+#else
+    if (m_map)
+        munmap(m_map, m_mapSize);
+    if (m_fd >= 0)
+        close(m_fd);
+    m_fd = -1;
+#endif
+    m_map = 0;
+    m_mapSize = 0;
+}
+
+// the file name suffix of this instance, like the dark library's
+static wxString InstanceSuffix(int instanceNumber)
+{
+    return instanceNumber > 1 ? wxString::Format("_%d", instanceNumber) : wxString();
+}
+
+bool FlightRecorder::Open(void)
+{
+    // another instance writing to the same file would have its live frames
+    // taken for a previous session and its ring reset under it
+    m_path = wxFileName(Debug.GetLogDir(), "PHD2_FlightRecorder" + InstanceSuffix(m_instanceNumber) + ".dat").GetFullPath();
+
+    // Frames are only left in the file if PHD2 did not shut down cleanly,
+    // which is when they are most wanted
+    wxULongLong len = wxFileName::GetSize(m_path);
+    if (len != wxInvalidSize && len.GetValue() >= sizeof(FlightRecorderHeader) && !Map((size_t) len.GetValue()))
+    {
+        const FlightRecorderHeader *hdr = Header();
+        if (memcmp(hdr->magic, FLIGHT_RECORDER_MAGIC, sizeof(hdr->magic)) == 0 &&
+            hdr->slotSize == SlotSize() && hdr->count > 0 && hdr->count <= hdr->slotCount && hdr->next < hdr->slotCount &&
+            sizeof(FlightRecorderHeader) + (size_t) hdr->slotCount * hdr->slotSize <= m_mapSize)
+        {
+            wxString filename;
+            DumpRing("previous session", hdr->count, &filename);
+        }
+        Unmap();
+    }
+
+    size_t size = (size_t) m_sizeMb * 1024 * 1024;
+    if (Map(size))
+    {
+        Debug.AddLine("Flight recorder: could not map " + m_path);
+        return true;
+    }
+
+    FlightRecorderHeader *hdr = Header();
+    memcpy(hdr->magic, FLIGHT_RECORDER_MAGIC, sizeof(hdr->magic));
+    hdr->slotSize = SlotSize();
+    hdr->slotCount = (unsigned int) ((size - sizeof(FlightRecorderHeader)) / hdr->slotSize);
+    hdr->next = 0;
+    hdr->count = 0;
+
+    Debug.AddLine("Flight recorder: %u frames in %s", hdr->slotCount, m_path);
+
+    return false;
+}
+
+void FlightRecorder::Close(void)
+{
+    if (!m_map)
+        return;
+
+    // a clean close leaves nothing to recover at the next start
+    Header()->count = 0;
+    Unmap();
+}
+
+void FlightRecorder::SetInstanceNumber(int instanceNumber)
+{
+    m_instanceNumber = instanceNumber;
+}
+
+void FlightRecorder::LoadProfileSettings(void)
+{
+    SetSizeMb(pConfig->Profile.GetInt("/FlightRecorder/SizeMb", DefaultFlightRecorderSizeMb));
+    SetEnabled(pConfig->Profile.GetBoolean("/FlightRecorder/Enabled", DefaultFlightRecorderEnabled));
+}
+
+bool FlightRecorder::SetEnabled(bool enable)
+{
+    bool bError = false;
+
+    if (enable && !m_map)
+        bError = Open();
+    else if (!enable)
+        Close();
+
+    m_enabled = enable && !bError;
+
+    pConfig->Profile.SetBoolean("/FlightRecorder/Enabled", enable);
+
+    return bError;
+}
+
+bool FlightRecorder::SetSizeMb(int sizeMb)
+{
+    bool bError = false;
+
+    try
+    {
+        if (sizeMb < MinFlightRecorderSizeMb || sizeMb > MaxFlightRecorderSizeMb)
+        {
+            throw ERROR_INFO("invalid flight recorder size");
+        }
+    }
+    catch (wxString Msg)
+    {
+        POSSIBLY_UNUSED(Msg);
+        bError = true;
+        sizeMb = DefaultFlightRecorderSizeMb;
+    }
+
+    if (sizeMb != m_sizeMb)
+    {
+        m_sizeMb = sizeMb;
+
+        if (m_map)
+        {
+            Close();
+            if (Open())
+                m_enabled = false;
+        }
+    }
+
+    pConfig->Profile.SetInt("/FlightRecorder/SizeMb", m_sizeMb);
+
+    return bError;
+}
+
+void FlightRecorder::Record(const usImage& img, const FlightRecorderFrame& frame)
+{
+    if (!m_map || !img.ImageData)
+        return;
+
+    FlightRecorderHeader *hdr = Header();
+    FlightRecorderSlot *slot = Slot(hdr->next);
+
+    // keep the region around the star, or around the lock position or the
+    // subframe if there is no star
+    PHD_Point center;
+    if (frame.star.IsValid())
+        center = frame.star;
+    else if (frame.lock.IsValid())
+        center = frame.lock;
+    else if (!img.Subframe.IsEmpty())
+        center = PHD_Point(img.Subframe.x + img.Subframe.width / 2, img.Subframe.y + img.Subframe.height / 2);
+    else
+        center = PHD_Point(img.Size.GetWidth() / 2, img.Size.GetHeight() / 2);
+
+    int const width = wxMin((int) MAX_DIM, img.Size.GetWidth());
+    int const height = wxMin((int) MAX_DIM, img.Size.GetHeight());
+    int const x = wxMax(0, wxMin(ROUND(center.X) - width / 2, img.Size.GetWidth() - width));
+    int const y = wxMax(0, wxMin(ROUND(center.Y) - height / 2, img.Size.GetHeight() - height));
+
+    wxLongLong_t startMs = ::wxGetUTCTimeMillis().GetValue();
+    if (img.ImgExposureStartUs)
+        startMs -= (LatencyStats::Now() - img.ImgExposureStartUs) / 1000;
+
+    slot->startMs = startMs;
+    slot->frameNumber = frame.frameNumber;
+    slot->exposure = img.ImgExpDur;
+    slot->guiderState = frame.guiderState;
+    slot->flags = (frame.starLost ? SLOT_STAR_LOST : 0) |
+        (frame.star.IsValid() ? SLOT_STAR_VALID : 0) |
+        (frame.lock.IsValid() ? SLOT_LOCK_VALID : 0);
+    slot->frameWidth = img.Size.GetWidth();
+    slot->frameHeight = img.Size.GetHeight();
+    slot->x = x;
+    slot->y = y;
+    slot->width = width;
+    slot->height = height;
+    slot->starX = frame.star.IsValid() ? frame.star.X : 0.0;
+    slot->starY = frame.star.IsValid() ? frame.star.Y : 0.0;
+    slot->lockX = frame.lock.IsValid() ? frame.lock.X : 0.0;
+    slot->lockY = frame.lock.IsValid() ? frame.lock.Y : 0.0;
+    slot->mass = frame.mass;
+    slot->snr = frame.snr;
+
+    unsigned short *dst = SlotPixels(slot);
+    const unsigned short *src = img.ImageData + y * img.Size.GetWidth() + x;
+    for (int row = 0; row < height; row++)
+    {
+        memcpy(dst, src, width * sizeof(unsigned short));
+        dst += width;
+        src += img.Size.GetWidth();
+    }
+
+    hdr->next = (hdr->next + 1) % hdr->slotCount;
+    if (hdr->count < hdr->slotCount)
+        ++hdr->count;
+}
+
+static void WriteKey(fitsfile *fptr, int type, const char *name, void *value, const char *comment, int *status)
+{
+    fits_write_key(fptr, type, const_cast<char *>(name), value, const_cast<char *>(comment), status);
+}
+
+// Each frame is an image HDU holding the region around the star. The region
+// origin is in XORGSUB/YORGSUB and the guider's measurements, in full frame
+// coordinates, are in the header. Writes n slots of a ring of slotCount
+// slots, starting at first; any thread.
+static bool WriteFrames(const wxString& path, const wxString& reason, char *slots, unsigned int slotSize,
+                        unsigned int slotCount, unsigned int first, unsigned int n)
+{
+    fitsfile *fptr;  // FITS file pointer
+    int status = 0;  // CFITSIO status value MUST be initialized to zero!
+
+    if (PHD_fits_create_file(&fptr, path, true, &status))
+    {
+        Debug.AddLine("Flight recorder: could not create " + path);
+        return true;
+    }
+
+    for (unsigned int i = 0; i < n && !status; i++)
+    {
+        FlightRecorderSlot *slot = reinterpret_cast<FlightRecorderSlot *>(slots + (size_t) ((first + i) % slotCount) * slotSize);
+
+        long fsize[2] = { slot->width, slot->height };
+        fits_create_img(fptr, USHORT_IMG, 2, fsize, &status);
+
+        if (i == 0)
+        {
+            wxCharBuffer why = reason.ToAscii();
+            WriteKey(fptr, TSTRING, "REASON", why.data(), "why the flight recorder was saved", &status);
+        }
+
+        wxString dateobs = wxDateTime(wxLongLong(slot->startMs)).Format(_T("%Y-%m-%dT%H:%M:%S.%l"), wxDateTime::UTC);
+        wxCharBuffer date = dateobs.ToAscii();
+        WriteKey(fptr, TSTRING, "DATE-OBS", date.data(), "exposure start, UT", &status);
+        float exposure = (float) slot->exposure / 1000.0;
+        WriteKey(fptr, TFLOAT, "EXPOSURE", &exposure, "Exposure time in seconds", &status);
+        WriteKey(fptr, TUINT, "FRAMENUM", &slot->frameNumber, "frame number", &status);
+        WriteKey(fptr, TINT, "GSTATE", &slot->guiderState, "guider state", &status);
+        int lost = (slot->flags & SLOT_STAR_LOST) ? 1 : 0;
+        WriteKey(fptr, TLOGICAL, "STARLOST", &lost, "star was not found", &status);
+        WriteKey(fptr, TINT, "FRAMEW", &slot->frameWidth, "full frame width", &status);
+        WriteKey(fptr, TINT, "FRAMEH", &slot->frameHeight, "full frame height", &status);
+        WriteKey(fptr, TINT, "XORGSUB", &slot->x, "Subframe x position", &status);
+        WriteKey(fptr, TINT, "YORGSUB", &slot->y, "Subframe y position", &status);
+        if (slot->flags & SLOT_STAR_VALID)
+        {
+            WriteKey(fptr, TDOUBLE, "STARX", &slot->starX, "star x position in full frame", &status);
+            WriteKey(fptr, TDOUBLE, "STARY", &slot->starY, "star y position in full frame", &status);
+            WriteKey(fptr, TDOUBLE, "STARMASS", &slot->mass, "star mass", &status);
+            WriteKey(fptr, TDOUBLE, "STARSNR", &slot->snr, "star SNR", &status);
+        }
+        if (slot->flags & SLOT_LOCK_VALID)
+        {
+            WriteKey(fptr, TDOUBLE, "LOCKX", &slot->lockX, "lock x position in full frame", &status);
+            WriteKey(fptr, TDOUBLE, "LOCKY", &slot->lockY, "lock y position in full frame", &status);
+        }
+
+        long fpixel[2] = { 1, 1 };
+        fits_write_pix(fptr, TUSHORT, fpixel, (long) slot->width * slot->height, SlotPixels(slot), &status);
+    }
+
+    PHD_fits_close_file(fptr);
+
+    Debug.AddLine(wxString::Format("Flight recorder: %u frames (%s) written to %s, status %d", n, reason, path, status));
+
+    return status != 0;
+}
+
+// A copy of the most recent frames, written by the ImageWriter thread so a
+// lost star does not stall the main thread while the file is written
+class FlightRecorderDumpJob : public ImageWriteJob
+{
+    wxString m_reason;
+    std::vector<char> m_slots;
+    unsigned int m_slotSize;
+    unsigned int m_count;
+
+public:
+    FlightRecorderDumpJob(const wxString& fileName, const wxString& reason, unsigned int slotSize, unsigned int count)
+        : ImageWriteJob(0, fileName), m_reason(reason), m_slots((size_t) slotSize * count), m_slotSize(slotSize), m_count(count) { }
+
+    char *Slot(unsigned int i) { return &m_slots[(size_t) i * m_slotSize]; }
+
+    bool Write(const wxString& path)
+    {
+        return WriteFrames(path, m_reason, &m_slots[0], m_slotSize, m_count, 0, m_count);
+    }
+};
+
+wxString FlightRecorder::DumpFileName(void) const
+{
+    return wxFileName(Debug.GetLogDir(),
+        "PHD2_FlightRecorder" + InstanceSuffix(m_instanceNumber) + wxDateTime::Now().Format(_T("_%Y-%m-%d_%H%M%S")) + ".fits").GetFullPath();
+}
+
+bool FlightRecorder::DumpRing(const wxString& reason, unsigned int maxFrames, wxString *filename)
+{
+    const FlightRecorderHeader *hdr = Header();
+    unsigned int const n = wxMin(maxFrames, hdr->count);
+
+    if (n == 0)
+        return true;
+
+    wxString fname = DumpFileName();
+    unsigned int const first = (hdr->next + hdr->slotCount - n) % hdr->slotCount;
+
+    *filename = fname;
+    return WriteFrames(fname, reason, m_map + sizeof(FlightRecorderHeader), hdr->slotSize, hdr->slotCount, first, n);
+}
+
+bool FlightRecorder::Dump(const wxString& reason, wxString *filename)
+{
+    if (!m_map)
+        return true;
+
+    return DumpRing(reason, Header()->count, filename);
+}
+
+void FlightRecorder::DumpOnEvent(const wxString& reason)
+{
+    if (!m_map)
+        return;
+
+    // the star can be lost on many frames in a row
+    wxLongLong_t now = ::wxGetUTCTimeMillis().GetValue();
+    if (m_lastEventDump && now - m_lastEventDump < EVENT_DUMP_INTERVAL_MS)
+        return;
+    m_lastEventDump = now;
+
+    const FlightRecorderHeader *hdr = Header();
+    unsigned int const n = wxMin((unsigned int) EVENT_DUMP_FRAMES, hdr->count);
+    if (n == 0)
+        return;
+
+    // copy the frames now, before the ring moves on, and write them in
+    // the background
+    FlightRecorderDumpJob *job = new FlightRecorderDumpJob(DumpFileName(), reason, hdr->slotSize, n);
+    unsigned int const first = (hdr->next + hdr->slotCount - n) % hdr->slotCount;
+    for (unsigned int i = 0; i < n; i++)
+        memcpy(job->Slot(i), Slot((first + i) % hdr->slotCount), hdr->slotSize);
+
+    ImgWriter.Queue(job);
+}
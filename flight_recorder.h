@@ -0,0 +1,121 @@
+/*
+ *  flight_recorder.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2016 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef FLIGHT_RECORDER_H_INCLUDED
+#define FLIGHT_RECORDER_H_INCLUDED
+
+struct FlightRecorderHeader;
+struct FlightRecorderSlot;
+
+// what the guider knew about the frame when it was recorded
+struct FlightRecorderFrame
+{
+    unsigned int frameNumber;
+    int guiderState;
+    bool starLost;
+    PHD_Point star;
+    PHD_Point lock;
+    double mass;
+    double snr;
+};
+
+// Keeps the guide star region of every processed frame, with the guider's
+// measurements, in a ring in a memory-mapped file in the log directory.
+// Recording a frame is a copy into the mapped file; the OS writes it out,
+// so the frames survive a crash. The ring is written to a FITS file on
+// demand, when the star is lost or calibration fails, and when PHD2 starts
+// and finds frames left from the previous session. The star lost and
+// calibration failure files are written by the ImageWriter thread from a
+// copy of the frames. Main thread only.
+class FlightRecorder
+{
+public:
+    enum { MAX_DIM = 128 };     // size of the region kept around the star, pixels
+
+private:
+    bool m_enabled;
+    int m_sizeMb;
+    int m_instanceNumber;       // each instance has its own ring file
+    wxString m_path;
+    size_t m_mapSize;
+    char *m_map;
+#ifdef __WINDOWS__
+    WXHANDLE m_file;
+    WXHANDLE m_mapping;
+#else
+    int m_fd;
+#endif
+    wxLongLong_t m_lastEventDump;
+
+    bool Map(size_t size);
+    void Unmap(void);
+    bool Open(void);
+    void Close(void);
+    FlightRecorderHeader *Header(void) const;
+    FlightRecorderSlot *Slot(unsigned int i) const;
+    wxString DumpFileName(void) const;
+    bool DumpRing(const wxString& reason, unsigned int maxFrames, wxString *filename);
+
+public:
+    FlightRecorder(void);
+    ~FlightRecorder(void);
+
+    void SetInstanceNumber(int instanceNumber);
+    void LoadProfileSettings(void);
+    bool SetEnabled(bool enable);
+    bool GetEnabled(void) const;
+    bool SetSizeMb(int sizeMb);
+    int GetSizeMb(void) const;
+
+    void Record(const usImage& img, const FlightRecorderFrame& frame);
+
+    // write the recorded frames to a FITS file in the log directory
+    bool Dump(const wxString& reason, wxString *filename);
+    // like Dump but only the most recent frames, not more than once a minute,
+    // and written in the background
+    void DumpOnEvent(const wxString& reason);
+};
+
+extern FlightRecorder FlightRec;
+
+inline bool FlightRecorder::GetEnabled(void) const
+{
+    return m_enabled;
+}
+
+inline int FlightRecorder::GetSizeMb(void) const
+{
+    return m_sizeMb;
+}
+
+#endif /* FLIGHT_RECORDER_H_INCLUDED */
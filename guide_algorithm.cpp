@@ -47,3 +47,46 @@ wxString GuideAlgorithm::GetAxis()
 {
     return (m_guideAxis == GUIDE_RA ? _("RA") : _("DEC"));
 }
+
+GuideHistory::GuideHistory(unsigned int capacity)
+    : m_values(capacity)
+{
+}
+
+void GuideHistory::Clear(void)
+{
+    m_values.clear();
+}
+
+void GuideHistory::Add(double y)
+{
+    m_values.push_front(y);
+}
+
+double GuideHistory::Slope(void) const
+{
+    // The sums are taken in the same order as CalcSlope so the result is
+    // the same to the last bit. Running sums would round differently, and
+    // the history is only a few values long.
+
+    int nn = (int) m_values.size();
+
+    if (nn < 2)
+        return 0.;
+
+    double s_xy = 0.0;
+    double s_y = 0.0;
+
+    for (int x = 0; x < nn; x++)
+    {
+        s_xy += (double)(x + 1) * m_values[x];
+        s_y += m_values[x];
+    }
+
+    int sx = (nn * (nn + 1)) / 2;
+    int sxx = sx * (2 * nn + 1) / 3;
+    double s_x = (double) sx;
+    double s_xx = (double) sxx;
+    double n = (double) nn;
+    return (n * s_xy - (s_x * s_y)) / (n * s_xx - (s_x * s_x));
+}
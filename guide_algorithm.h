@@ -64,6 +64,22 @@ enum GuideAxis
     GUIDE_Y = GUIDE_DEC,
 };
 
+// The most recent inputs of a guide algorithm, oldest first, in fixed
+// storage, so adding a value never moves the history or allocates.
+class GuideHistory
+{
+    circular_buffer<double> m_values;
+
+public:
+    GuideHistory(unsigned int capacity);
+
+    void Clear(void);
+    void Add(double y);                 // drops the oldest value when full
+    unsigned int Count(void) const { return m_values.size(); }
+    double operator[](unsigned int n) const { return m_values[n]; }
+    double Slope(void) const;           // least-squares slope, the same as CalcSlope
+};
+
 class GuideAlgorithm
 {
 protected:
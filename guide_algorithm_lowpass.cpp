@@ -43,7 +43,8 @@ static const double DefaultMinMove     = 0.2;
 static const double DefaultSlopeWeight = 5.0;
 
 GuideAlgorithmLowpass::GuideAlgorithmLowpass(Mount *pMount, GuideAxis axis)
-    : GuideAlgorithm(pMount, axis)
+    : GuideAlgorithm(pMount, axis),
+      m_history(HISTORY_SIZE)
 {
     double minMove     = pConfig->Profile.GetDouble(GetConfigPath() + "/minMove", DefaultMinMove);
     SetMinMove(minMove);
@@ -65,25 +66,45 @@ GUIDE_ALGORITHM GuideAlgorithmLowpass::Algorithm(void)
 
 void GuideAlgorithmLowpass::reset(void)
 {
-    m_history.Empty();
+    m_history.Clear();
 
-    while (m_history.GetCount() < HISTORY_SIZE)
+    while (m_history.Count() < HISTORY_SIZE)
     {
         m_history.Add(0.0);
     }
+
+    for (unsigned int i = 0; i < HISTORY_SIZE; i++)
+    {
+        m_sorted[i] = 0.0;
+    }
 }
 
 double GuideAlgorithmLowpass::result(double input)
 {
-    m_history.Add(input);
+    // the median is taken over the history and the input, so insert the
+    // input into the sorted history before dropping the oldest value
+    unsigned int i = HISTORY_SIZE;
+    while (i > 0 && m_sorted[i - 1] > input)
+    {
+        m_sorted[i] = m_sorted[i - 1];
+        --i;
+    }
+    m_sorted[i] = input;
 
-    ArrayOfDbl sortedHistory(m_history);
-    sortedHistory.Sort(dbl_sort_func);
+    double median = m_sorted[(HISTORY_SIZE + 1) / 2];
 
-    m_history.RemoveAt(0);
+    double oldest = m_history[0];
+    i = 0;
+    while (i < HISTORY_SIZE && m_sorted[i] != oldest)
+        ++i;
+    for (; i < HISTORY_SIZE; i++)
+    {
+        m_sorted[i] = m_sorted[i + 1];
+    }
+
+    m_history.Add(input);
 
-    double median = sortedHistory[sortedHistory.GetCount()/2];
-    double slope = CalcSlope(m_history);
+    double slope = m_history.Slope();
     double dReturn = median + m_slopeWeight*slope;
 
     if (fabs(dReturn) > fabs(input))
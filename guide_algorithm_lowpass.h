@@ -44,7 +44,8 @@ class GuideAlgorithmLowpass : public GuideAlgorithm
 {
     static const unsigned int HISTORY_SIZE = 10;
 
-    ArrayOfDbl m_history;
+    GuideHistory m_history;
+    double m_sorted[HISTORY_SIZE + 1];  // the history in ascending order, with room for the new input
     double m_slopeWeight;
     double m_minMove;
 
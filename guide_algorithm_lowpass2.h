@@ -44,7 +44,7 @@ class GuideAlgorithmLowpass2 : public GuideAlgorithm
 {
     static const unsigned int HISTORY_SIZE = 10;
 
-    ArrayOfDbl m_history;
+    GuideHistory m_history;
     double m_aggressiveness;
     double m_minMove;
     int m_rejects;
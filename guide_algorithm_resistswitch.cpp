@@ -43,7 +43,9 @@ static const double DefaultMinMove = 0.2;
 static const double DefaultAggression = 1.0;
 
 GuideAlgorithmResistSwitch::GuideAlgorithmResistSwitch(Mount *pMount, GuideAxis axis)
-    : GuideAlgorithm(pMount, axis)
+    : GuideAlgorithm(pMount, axis),
+      m_history(HISTORY_SIZE),
+      m_signSum(0)
 {
     double minMove  = pConfig->Profile.GetDouble(GetConfigPath() + "/minMove", DefaultMinMove);
     SetMinMove(minMove);
@@ -66,18 +68,6 @@ GUIDE_ALGORITHM GuideAlgorithmResistSwitch::Algorithm(void)
     return GUIDE_ALGORITHM_RESIST_SWITCH;
 }
 
-void GuideAlgorithmResistSwitch::reset(void)
-{
-    m_history.Empty();
-
-    while (m_history.GetCount() < HISTORY_SIZE)
-    {
-        m_history.Add(0.0);
-    }
-
-    m_currentSide = 0;
-}
-
 static int sign(double x)
 {
     int iReturn = 0;
@@ -94,82 +84,109 @@ static int sign(double x)
     return iReturn;
 }
 
-double GuideAlgorithmResistSwitch::result(double input)
+// the direction a history value votes for, if it is large enough to count
+int GuideAlgorithmResistSwitch::Vote(double x) const
 {
-    double dReturn = input;
+    return fabs(x) > m_minMove ? sign(x) : 0;
+}
 
-    m_history.Add(input);
-    m_history.RemoveAt(0);
+void GuideAlgorithmResistSwitch::CountSigns(void)
+{
+    m_signSum = 0;
 
-    try
+    for (unsigned int i = 0; i < m_history.size(); i++)
     {
-        if (fabs(input) < m_minMove)
+        m_signSum += Vote(m_history[i]);
+    }
+}
+
+void GuideAlgorithmResistSwitch::reset(void)
+{
+    m_history.clear();
+
+    while (m_history.size() < HISTORY_SIZE)
+    {
+        m_history.push_front(0.0);
+    }
+
+    m_signSum = 0;
+    m_currentSide = 0;
+}
+
+// Decide whether to move for this input, switching direction if the
+// history is compelling enough. Called on every guide step, so a vetoed
+// move is a plain return rather than an exception.
+bool GuideAlgorithmResistSwitch::MoveAllowed(double input)
+{
+    if (fabs(input) < m_minMove)
+    {
+        LOG_INFO("input < m_minMove");
+        return false;
+    }
+
+    if (m_fastSwitchEnabled)
+    {
+        double thresh = 3.0 * m_minMove;
+        if (sign(input) != m_currentSide && fabs(input) > thresh)
         {
-            throw THROW_INFO("input < m_minMove");
+            Debug.Write(wxString::Format("resist switch: large excursion: input %.2f thresh %.2f direction from %d to %d\n", input, thresh, m_currentSide, sign(input)));
+            // force switch
+            m_currentSide = 0;
+            unsigned int i;
+            for (i = 0; i < HISTORY_SIZE - 3; i++)
+                m_history[i] = 0.0;
+            for (; i < HISTORY_SIZE; i++)
+                m_history[i] = input;
+            m_signSum = 3 * Vote(input);
         }
+    }
 
-        if (m_fastSwitchEnabled)
+    int decHistory = m_signSum;
+
+    if (m_currentSide == 0 || sign(m_currentSide) == -sign(decHistory))
+    {
+        if (abs(decHistory) < 3)
         {
-            double thresh = 3.0 * m_minMove;
-            if (sign(input) != m_currentSide && fabs(input) > thresh)
-            {
-                Debug.Write(wxString::Format("resist switch: large excursion: input %.2f thresh %.2f direction from %d to %d\n", input, thresh, m_currentSide, sign(input)));
-                // force switch
-                m_currentSide = 0;
-                unsigned int i;
-                for (i = 0; i < HISTORY_SIZE - 3; i++)
-                    m_history[i] = 0.0;
-                for (; i < HISTORY_SIZE; i++)
-                    m_history[i] = input;
-            }
+            LOG_INFO("not compelling enough");
+            return false;
         }
 
-        int decHistory = 0;
+        double oldest = 0.0;
+        double newest = 0.0;
 
-        for (unsigned int i = 0; i < m_history.GetCount(); i++)
+        for (int i = 0; i < 3; i++)
         {
-            if (fabs(m_history[i]) > m_minMove)
-            {
-                decHistory += sign(m_history[i]);
-            }
+            oldest += m_history[i];
+            newest += m_history[m_history.size() - (i + 1)];
         }
 
-        if (m_currentSide == 0 || sign(m_currentSide) == -sign(decHistory))
+        if (fabs(newest) <= fabs(oldest))
         {
-            if (abs(decHistory) < 3)
-            {
-                throw THROW_INFO("not compelling enough");
-            }
+            LOG_INFO("Not getting worse");
+            return false;
+        }
 
-            double oldest = 0.0;
-            double newest = 0.0;
+        Debug.Write(wxString::Format("switching direction from %d to %d - decHistory=%d oldest=%.2f newest=%.2f\n", m_currentSide, sign(decHistory), decHistory, oldest, newest));
 
-            for (int i = 0; i < 3; i++)
-            {
-                oldest += m_history[i];
-                newest += m_history[m_history.GetCount() - (i + 1)];
-            }
+        m_currentSide = sign(decHistory);
+    }
 
-            if (fabs(newest) <= fabs(oldest))
-            {
-                throw THROW_INFO("Not getting worse");
-            }
+    if (m_currentSide != sign(input))
+    {
+        LOG_INFO("must have overshot -- vetoing move");
+        return false;
+    }
 
-            Debug.Write(wxString::Format("switching direction from %d to %d - decHistory=%d oldest=%.2f newest=%.2f\n", m_currentSide, sign(decHistory), decHistory, oldest, newest));
+    return true;
+}
 
-            m_currentSide = sign(decHistory);
-        }
+double GuideAlgorithmResistSwitch::result(double input)
+{
+    // the history is always full, so the oldest value drops out
+    m_signSum += Vote(input) - Vote(m_history[0]);
+    m_history.push_front(input);
 
-        if (m_currentSide != sign(input))
-        {
-            throw THROW_INFO("must have overshot -- vetoing move");
-        }
-    }
-    catch (const wxString& Msg)
-    {
-        POSSIBLY_UNUSED(Msg);
-        dReturn = 0.0;
-    }
+    double dReturn = MoveAllowed(input) ? input : 0.0;
 
     Debug.Write(wxString::Format("GuideAlgorithmResistSwitch::Result() returns %.2f from input %.2f\n", dReturn, input));
 
@@ -197,6 +214,8 @@ bool GuideAlgorithmResistSwitch::SetMinMove(double minMove)
         m_minMove = DefaultMinMove;
     }
 
+    CountSigns();
+
     pConfig->Profile.SetDouble(GetConfigPath() + "/minMove", m_minMove);
 
     Debug.Write(wxString::Format("GuideAlgorithmResistSwitch::SetMinMove() returns %d, m_minMove=%.2f\n", bError, m_minMove));
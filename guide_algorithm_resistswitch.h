@@ -44,12 +44,17 @@ class GuideAlgorithmResistSwitch : public GuideAlgorithm
 {
     static const unsigned int HISTORY_SIZE = 10;
 
-    ArrayOfDbl m_history;
+    circular_buffer<double> m_history;
+    int m_signSum;              // sum of the signs of the history values larger than m_minMove
     double m_minMove;
     double m_aggression;
     bool m_fastSwitchEnabled;
     int    m_currentSide;
 
+    int Vote(double x) const;
+    void CountSigns(void);
+    bool MoveAllowed(double input);
+
 protected:
     class GuideAlgorithmResistSwitchConfigDialogPane : public ConfigDialogPane
     {
@@ -0,0 +1,177 @@
+/*
+ *  guide_step_bus.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2016 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "phd.h"
+
+#include "guiding_assistant.h"
+
+GuideStepBus GuideSteps;
+
+GuideStepBus::GuideStepBus(void)
+    : m_head(0),
+      m_count(0),
+      m_dropped(0),
+      m_dispatchQueued(false)
+{
+    Bind(wxEVT_THREAD, &GuideStepBus::OnDispatch, this);
+}
+
+void GuideStepBus::Publish(const GuideStepInfo& step)
+{
+    bool queueDispatch;
+
+    {
+        wxCriticalSectionLocker lock(m_lock);
+
+        if (m_count == CAPACITY)
+        {
+            // the main thread is not keeping up; the pulse has been sent
+            // already, so lose the oldest step rather than wait
+            m_head = (m_head + 1) % CAPACITY;
+            --m_count;
+            ++m_dropped;
+        }
+
+        m_ring[(m_head + m_count) % CAPACITY] = step;
+        ++m_count;
+
+        queueDispatch = !m_dispatchQueued;
+        m_dispatchQueued = true;
+    }
+
+    if (queueDispatch)
+        wxQueueEvent(this, new wxThreadEvent());
+}
+
+void GuideStepBus::OnDispatch(wxThreadEvent& WXUNUSED(evt))
+{
+    Dispatch();
+}
+
+void GuideStepBus::Dispatch(void)
+{
+    if (!wxIsMainThread())
+        return;
+
+    while (true)
+    {
+        GuideStepInfo step;
+        unsigned int dropped;
+
+        {
+            wxCriticalSectionLocker lock(m_lock);
+
+            if (m_count == 0)
+            {
+                m_dispatchQueued = false;
+                return;
+            }
+
+            step = m_ring[m_head];
+            m_head = (m_head + 1) % CAPACITY;
+            --m_count;
+
+            dropped = m_dropped;
+            m_dropped = 0;
+        }
+
+        if (dropped)
+            Debug.AddLine("GuideStepBus: %u guide steps dropped", dropped);
+
+        Deliver(step);
+    }
+}
+
+void GuideStepBus::Discard(const Mount *mount)
+{
+    unsigned int discarded;
+
+    {
+        wxCriticalSectionLocker lock(m_lock);
+
+        unsigned int kept = 0;
+
+        for (unsigned int i = 0; i < m_count; i++)
+        {
+            const GuideStepInfo& step = m_ring[(m_head + i) % CAPACITY];
+            if (step.mount == mount)
+                continue;
+            if (kept != i)
+                m_ring[(m_head + kept) % CAPACITY] = step;
+            ++kept;
+        }
+
+        discarded = m_count - kept;
+        m_count = kept;
+    }
+
+    if (discarded)
+        Debug.AddLine("GuideStepBus: %u guide steps discarded, the mount is going away", discarded);
+}
+
+void GuideStepBus::Deliver(const GuideStepInfo& step)
+{
+    GuideLog.GuideStep(step);
+    EvtServer.NotifyGuideStep(step);
+
+    if (!pFrame)
+        return;
+
+    wxString msg;
+
+    if (step.durationRA > 0)
+    {
+        msg = wxString::Format(_("%s %5.2f px %3d ms"), step.directionRA == EAST ? _("East") : _("West"),
+            fabs(step.guideDistanceRA), step.durationRA);
+    }
+
+    if (step.durationDec > 0)
+    {
+        msg = wxString::Format(_("%s%*s%s %.2f px %d ms"), msg,
+            msg.IsEmpty() ? 42 : msg.Len() < 30 ? 30 - msg.Len() : 1, "",
+            step.directionDec == SOUTH ? _("South") : _("North"),
+            fabs(step.guideDistanceDec), step.durationDec);
+    }
+
+    if (!msg.IsEmpty())
+        pFrame->SetStatusText(msg, 1);
+
+    if (step.normalMove)
+    {
+        wxLongLong_t start = LatencyStats::Now();
+        pFrame->pGraphLog->AppendData(step);
+        pFrame->pTarget->AppendData(step);
+        GuidingAssistant::NotifyGuideStep(step);
+        pFrame->m_uiRefresh.GuideStepAppended(LatencyStats::Now() - start);
+    }
+}
@@ -0,0 +1,71 @@
+/*
+ *  guide_step_bus.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2016 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef GUIDE_STEP_BUS_H_INCLUDED
+#define GUIDE_STEP_BUS_H_INCLUDED
+
+// Carries guide steps from the threads that move the mounts to the guide
+// log, event server, status bar and display windows. Publishing only copies
+// the step into a ring; the consumers run on the main thread, so the file,
+// socket and window work never delays the guide pulses.
+class GuideStepBus : public wxEvtHandler
+{
+    enum { CAPACITY = 256 };
+
+    wxCriticalSection m_lock;   // held only while copying steps in or out
+    GuideStepInfo m_ring[CAPACITY];
+    unsigned int m_head;        // oldest step
+    unsigned int m_count;
+    unsigned int m_dropped;     // steps lost because the ring was full
+    bool m_dispatchQueued;
+
+    void OnDispatch(wxThreadEvent& evt);
+    void Deliver(const GuideStepInfo& step);
+
+public:
+    GuideStepBus(void);
+
+    // may be called from any thread
+    void Publish(const GuideStepInfo& step);
+
+    // deliver the pending steps now; main thread only
+    void Dispatch(void);
+
+    // drop the pending steps of a mount that is going away; may be called
+    // from any thread
+    void Discard(const Mount *mount);
+};
+
+extern GuideStepBus GuideSteps;
+
+#endif /* GUIDE_STEP_BUS_H_INCLUDED */
@@ -635,18 +635,22 @@ void Guider::SetDefectMapPreview(const DefectMap *defectMap)
 
 bool Guider::SaveCurrentImage(const wxString& fileName)
 {
-    return m_pCurrentImage->Save(fileName);
+    return ImgWriter.Save(*m_pCurrentImage, fileName);
 }
 
 void Guider::InvalidateLockPosition(void)
 {
-    m_lockPosition.Invalidate();
+    {
+        wxCriticalSectionLocker lock(m_analysisLock);
+        m_lockPosition.Invalidate();
+    }
     EvtServer.NotifyLockPositionLost();
     NudgeLockTool::UpdateNudgeLockControls();
 }
 
 bool Guider::SetLockPosition(const PHD_Point& position)
 {
+    wxCriticalSectionLocker lock(m_analysisLock);
     bool bError = false;
 
     try
@@ -703,6 +707,7 @@ bool Guider::SetLockPosToStarAtPosition(const PHD_Point& starPosHint)
 
 MOVE_LOCK_RESULT Guider::MoveLockPosition(const PHD_Point& mountDelta)
 {
+    wxCriticalSectionLocker lock(m_analysisLock);
     MOVE_LOCK_RESULT result = MOVE_LOCK_OK;
 
     try
@@ -759,6 +764,8 @@ MOVE_LOCK_RESULT Guider::MoveLockPosition(const PHD_Point& mountDelta)
 
 void Guider::SetState(GUIDER_STATE newState)
 {
+    wxCriticalSectionLocker lock(m_analysisLock);
+
     try
     {
         Debug.Write(wxString::Format("Changing from state %d to %d\n", m_state, newState));
@@ -962,6 +969,9 @@ void Guider::StartGuiding(void)
 
 void Guider::StopGuiding(void)
 {
+    // log and report the last guide steps before the stop
+    GuideSteps.Dispatch();
+
     // first, send a notification that we stopped
     switch (m_state)
     {
@@ -989,6 +999,8 @@ void Guider::StopGuiding(void)
 
 void Guider::Reset(bool fullReset)
 {
+    wxCriticalSectionLocker lock(m_analysisLock);
+
     SetState(STATE_UNINITIALIZED);
     if (fullReset)
     {
@@ -998,253 +1010,363 @@ void Guider::Reset(bool fullReset)
 
 /*************  A new image is ready ************************/
 
-void Guider::UpdateGuideState(usImage *pImage, bool bStopping)
+/*
+ * AnalyzeFrame runs on the processing thread before the frame is handed to
+ * the main thread. It only finds the star: the guider state, the lock
+ * position shift and scheduling the move stay on the main thread, which
+ * owns them. The star position is attached to the frame, so with pipelined
+ * exposures the next frame's star cannot be mistaken for this one's when
+ * UpdateGuideState gets it. Frames the main thread then discards (paused,
+ * stopping, stale) cost one star find.
+ */
+void Guider::AnalyzeFrame(usImage *pImage)
 {
-    wxString statusMessage;
+    wxCriticalSectionLocker lock(m_analysisLock);
 
-    try
+    delete pImage->ImgAnalysis;
+
+    FrameAnalysis *analysis = new FrameAnalysis();
+
+    wxLongLong_t start = LatencyStats::Now();
+    analysis->lost = UpdateCurrentPosition(pImage, &analysis->info);
+    CycleStats.AddSample(STAGE_CENTROID, LatencyStats::Now() - start);
+    CycleStats.FrameAnalyzed(*pImage);
+
+    analysis->star = CurrentPosition();
+    analysis->mass = StarMass();
+    analysis->snr = SNR();
+
+    pImage->ImgAnalysis = analysis;
+}
+
+// was the frame analysed on the processing thread?
+bool Guider::IsAnalyzedFrame(const usImage *pImage)
+{
+    return pImage && pImage->ImgAnalysis;
+}
+
+/*
+ * Does the state machine work of UpdateGuideState once the new image has
+ * been switched in. Lost stars, pauses and stops happen in ordinary
+ * guiding, so each of them is a plain return with the status message
+ * already set rather than an exception.
+ */
+void Guider::AdvanceGuideState(usImage *pImage, bool bStopping, const FrameAnalysis *analysis, wxString *statusMessage)
+{
+    if (bStopping)
     {
-        Debug.Write(wxString::Format("UpdateGuideState(): m_state=%d\n", m_state));
+        StopGuiding();
+        *statusMessage = _("Stopped Guiding");
+        LOG_INFO("Stopped Guiding");
+        return;
+    }
 
-        if (pImage)
-        {
-            // switch in the new image
+    assert(!pMount || !pMount->IsBusy() || pFrame->GetPipelinedExposures());
 
-            usImage *pPrevImage = m_pCurrentImage;
-            m_pCurrentImage = pImage;
-            delete pPrevImage;
-        }
-        else
-        {
-            pImage = m_pCurrentImage;
-        }
+    // shift lock position
+    if (LockPosShiftEnabled() && IsGuiding())
+    {
+        bool shiftFailed;
 
-        if (bStopping)
         {
-            StopGuiding();
-            statusMessage = _("Stopped Guiding");
-            throw THROW_INFO("Stopped Guiding");
+            wxCriticalSectionLocker lock(m_analysisLock);
+            shiftFailed = ShiftLockPosition();
         }
 
-        assert(!pMount || !pMount->IsBusy());
-
-        // shift lock position
-        if (LockPosShiftEnabled() && IsGuiding())
+        if (shiftFailed)
         {
-            if (ShiftLockPosition())
-            {
-                pFrame->Alert(_("Shifted lock position outside allowable area. Lock Position Shift disabled."));
-                EnableLockPosShift(false);
-            }
-            NudgeLockTool::UpdateNudgeLockControls();
+            pFrame->Alert(_("Shifted lock position outside allowable area. Lock Position Shift disabled."));
+            EnableLockPosShift(false);
         }
+        NudgeLockTool::UpdateNudgeLockControls();
+    }
 
-        FrameDroppedInfo info;
-
-        if (UpdateCurrentPosition(pImage, &info))
-        {
-            info.frameNumber = pFrame->m_frameCounter;
-            info.time = pFrame->TimeSinceGuidingStarted();
-            info.avgDist = CurrentError();
+    FrameDroppedInfo info;
+    bool lost;
+    PHD_Point star;
+    double mass;
+    double snr;
 
-            switch (m_state)
-            {
-                case STATE_UNINITIALIZED:
-                case STATE_SELECTING:
-                    EvtServer.NotifyLooping(pFrame->m_frameCounter);
-                    break;
-                case STATE_SELECTED:
-                    // we had a current position and lost it
-                    SetState(STATE_UNINITIALIZED);
-                    EvtServer.NotifyStarLost(info);
-                    break;
-                case STATE_CALIBRATING_PRIMARY:
-                case STATE_CALIBRATING_SECONDARY:
-                    Debug.AddLine("Star lost during calibration... blundering on");
-                    EvtServer.NotifyStarLost(info);
-                    pFrame->SetStatusText(_("star lost"), 1);
-                    break;
-                case STATE_GUIDING:
-                {
-                    GuideLog.FrameDropped(info);
-                    EvtServer.NotifyStarLost(info);
-                    GuidingAssistant::NotifyFrameDropped(info);
-                    pFrame->pGraphLog->AppendData(info);
-
-                    wxColor prevColor = GetBackgroundColour();
-                    SetBackgroundColour(wxColour(64,0,0));
-                    ClearBackground();
-                    wxBell();
-                    wxMilliSleep(100);
-                    SetBackgroundColour(prevColor);
-                    break;
-                }
+    if (analysis)
+    {
+        info = analysis->info;
+        lost = analysis->lost;
+        star = analysis->star;
+        mass = analysis->mass;
+        snr = analysis->snr;
+    }
+    else
+    {
+        wxCriticalSectionLocker lock(m_analysisLock);
+        wxLongLong_t start = LatencyStats::Now();
+        lost = UpdateCurrentPosition(pImage, &info);
+        CycleStats.AddSample(STAGE_CENTROID, LatencyStats::Now() - start);
+        CycleStats.FrameAnalyzed(*pImage);
+        star = CurrentPosition();
+        mass = StarMass();
+        snr = SNR();
+    }
 
-                case STATE_CALIBRATED:
-                case STATE_STOP:
-                    break;
-            }
+    if (FlightRec.GetEnabled())
+    {
+        FlightRecorderFrame frame;
+        frame.frameNumber = pFrame->m_frameCounter;
+        frame.guiderState = m_state;
+        frame.starLost = lost;
+        frame.star = star;
+        frame.lock = LockPosition();
+        frame.mass = lost ? 0.0 : mass;
+        frame.snr = lost ? 0.0 : snr;
+        FlightRec.Record(*pImage, frame);
+    }
 
-            statusMessage = info.status;
-            throw THROW_INFO("unable to update current position");
-        }
-        statusMessage = info.status;
+    if (lost)
+    {
+        // log and report the guide steps before the star lost event
+        GuideSteps.Dispatch();
 
-        // we have a star selected, so re-enable subframes
-        if (m_forceFullFrame)
-        {
-            Debug.AddLine("setting force full frames = false");
-            m_forceFullFrame = false;
-        }
+        info.frameNumber = pFrame->m_frameCounter;
+        info.time = pFrame->TimeSinceGuidingStarted();
+        info.avgDist = CurrentError();
 
         switch (m_state)
         {
             case STATE_UNINITIALIZED:
             case STATE_SELECTING:
-            case STATE_SELECTED:
                 EvtServer.NotifyLooping(pFrame->m_frameCounter);
                 break;
+            case STATE_SELECTED:
+                // we had a current position and lost it
+                SetState(STATE_UNINITIALIZED);
+                EvtServer.NotifyStarLost(info);
+                FlightRec.DumpOnEvent("star lost");
+                break;
             case STATE_CALIBRATING_PRIMARY:
             case STATE_CALIBRATING_SECONDARY:
-            case STATE_CALIBRATED:
+                Debug.AddLine("Star lost during calibration... blundering on");
+                EvtServer.NotifyStarLost(info);
+                FlightRec.DumpOnEvent("star lost");
+                pFrame->SetStatusText(_("star lost"), 1);
+                break;
             case STATE_GUIDING:
+            {
+                GuideLog.FrameDropped(info);
+                EvtServer.NotifyStarLost(info);
+                GuidingAssistant::NotifyFrameDropped(info);
+                pFrame->pGraphLog->AppendData(info);
+                FlightRec.DumpOnEvent("star lost");
+
+                wxColor prevColor = GetBackgroundColour();
+                SetBackgroundColour(wxColour(64,0,0));
+                ClearBackground();
+                wxBell();
+                wxMilliSleep(100);
+                SetBackgroundColour(prevColor);
+                break;
+            }
+
+            case STATE_CALIBRATED:
             case STATE_STOP:
                 break;
         }
 
-        if (IsPaused())
-        {
-            statusMessage = _("Paused");
-            throw THROW_INFO("Skipping frame - guider is paused");
-        }
+        *statusMessage = info.status;
+        LOG_INFO("unable to update current position");
+        return;
+    }
+    *statusMessage = info.status;
 
-        switch (m_state)
-        {
-            case STATE_SELECTING:
-                assert(CurrentPosition().IsValid());
-                SetLockPosition(CurrentPosition());
-                Debug.AddLine("CurrentPosition() valid, moving to STATE_SELECTED");
-                EvtServer.NotifyStarSelected(CurrentPosition());
-                SetState(STATE_SELECTED);
-                break;
-            case STATE_SELECTED:
-                // nothing to do but wait
-                break;
-            case STATE_CALIBRATING_PRIMARY:
-                if (!pMount->IsCalibrated())
-                {
-                    if (pMount->UpdateCalibrationState(CurrentPosition()))
-                    {
-                        SetState(STATE_UNINITIALIZED);
-                        statusMessage = _("calibration failed (primary)");
-                        throw ERROR_INFO("Calibration failed");
-                    }
+    pFrame->pProfile->UpdateData(pImage, star.X, star.Y);
 
-                    if (!pMount->IsCalibrated())
-                    {
-                        break;
-                    }
-                }
+    // we have a star selected, so re-enable subframes
+    if (m_forceFullFrame)
+    {
+        Debug.AddLine("setting force full frames = false");
+        m_forceFullFrame = false;
+    }
+
+    switch (m_state)
+    {
+        case STATE_UNINITIALIZED:
+        case STATE_SELECTING:
+        case STATE_SELECTED:
+            EvtServer.NotifyLooping(pFrame->m_frameCounter);
+            break;
+        case STATE_CALIBRATING_PRIMARY:
+        case STATE_CALIBRATING_SECONDARY:
+        case STATE_CALIBRATED:
+        case STATE_GUIDING:
+        case STATE_STOP:
+            break;
+    }
+
+    if (IsPaused())
+    {
+        *statusMessage = _("Paused");
+        LOG_INFO("Skipping frame - guider is paused");
+        return;
+    }
 
-                SetState(STATE_CALIBRATING_SECONDARY);
+    switch (m_state)
+    {
+        case STATE_SELECTING:
+            assert(CurrentPosition().IsValid());
+            SetLockPosition(CurrentPosition());
+            Debug.AddLine("CurrentPosition() valid, moving to STATE_SELECTED");
+            EvtServer.NotifyStarSelected(CurrentPosition());
+            SetState(STATE_SELECTED);
+            break;
+        case STATE_SELECTED:
+            // nothing to do but wait
+            break;
+        case STATE_CALIBRATING_PRIMARY:
+            if (!pMount->IsCalibrated())
+            {
+                if (pMount->UpdateCalibrationState(CurrentPosition()))
+                {
+                    SetState(STATE_UNINITIALIZED);
+                    *statusMessage = _("calibration failed (primary)");
+                    LOG_INFO("Calibration failed");
+                    FlightRec.DumpOnEvent("calibration failed");
+                    return;
+                }
 
-                if (m_state == STATE_CALIBRATING_SECONDARY)
+                if (!pMount->IsCalibrated())
                 {
-                    // if we really have a secondary mount, and it isn't calibrated,
-                    // we need to take another exposure before falling into the code
-                    // below.  If we don't have one, or it is calibrated, we can fall
-                    // through.  If we don't fall through, we end up displaying a frame
-                    // which has the lockpoint in the wrong place, and while I thought I
-                    // could live with it when I originally wrote the code, it bothered
-                    // me so I did this.  Ick.
                     break;
                 }
+            }
 
-                // Fall through
-            case STATE_CALIBRATING_SECONDARY:
-                if (pSecondaryMount && pSecondaryMount->IsConnected())
-                {
-                    if (!pSecondaryMount->IsCalibrated())
-                    {
-                        if (pSecondaryMount->UpdateCalibrationState(CurrentPosition()))
-                        {
-                            SetState(STATE_UNINITIALIZED);
-                            statusMessage = _("calibration failed (secondary)");
-                            throw ERROR_INFO("Calibration failed");
-                        }
-                    }
+            SetState(STATE_CALIBRATING_SECONDARY);
+
+            if (m_state == STATE_CALIBRATING_SECONDARY)
+            {
+                // if we really have a secondary mount, and it isn't calibrated,
+                // we need to take another exposure before falling into the code
+                // below.  If we don't have one, or it is calibrated, we can fall
+                // through.  If we don't fall through, we end up displaying a frame
+                // which has the lockpoint in the wrong place, and while I thought I
+                // could live with it when I originally wrote the code, it bothered
+                // me so I did this.  Ick.
+                break;
+            }
 
-                    if (!pSecondaryMount->IsCalibrated())
+            // Fall through
+        case STATE_CALIBRATING_SECONDARY:
+            if (pSecondaryMount && pSecondaryMount->IsConnected())
+            {
+                if (!pSecondaryMount->IsCalibrated())
+                {
+                    if (pSecondaryMount->UpdateCalibrationState(CurrentPosition()))
                     {
-                        break;
+                        SetState(STATE_UNINITIALIZED);
+                        *statusMessage = _("calibration failed (secondary)");
+                        LOG_INFO("Calibration failed");
+                        FlightRec.DumpOnEvent("calibration failed");
+                        return;
                     }
                 }
-                assert(!pSecondaryMount || !pSecondaryMount->IsConnected() || pSecondaryMount->IsCalibrated());
 
-                // camera angle is now known, so ok to calculate shift rate camera coords
-                UpdateLockPosShiftCameraCoords();
-                if (LockPosShiftEnabled())
+                if (!pSecondaryMount->IsCalibrated())
                 {
-                    GuideLog.NotifyLockShiftParams(m_lockPosShift, m_lockPosition.ShiftRate());
+                    break;
                 }
+            }
+            assert(!pSecondaryMount || !pSecondaryMount->IsConnected() || pSecondaryMount->IsCalibrated());
 
-                SetState(STATE_CALIBRATED);
-                // fall through
-            case STATE_CALIBRATED:
-                assert(m_state == STATE_CALIBRATED);
-                SetState(STATE_GUIDING);
-                pFrame->SetStatusText(_("Guiding..."), 1);
-                pFrame->m_guidingStarted = wxDateTime::UNow();
-                pFrame->m_frameCounter = 0;
-                GuideLog.StartGuiding();
-                EvtServer.NotifyStartGuiding();
-                break;
-            case STATE_GUIDING:
-                if (m_ditherRecenterRemaining.IsValid())
-                {
-                    // fast recenter after dither taking large steps and bypassing
-                    // guide algorithms (normalMove=false)
+            // camera angle is now known, so ok to calculate shift rate camera coords
+            UpdateLockPosShiftCameraCoords();
+            if (LockPosShiftEnabled())
+            {
+                GuideLog.NotifyLockShiftParams(m_lockPosShift, m_lockPosition.ShiftRate());
+            }
 
-                    PHD_Point step(wxMin(m_ditherRecenterRemaining.X, m_ditherRecenterStep.X),
-                                   wxMin(m_ditherRecenterRemaining.Y, m_ditherRecenterStep.Y));
+            SetState(STATE_CALIBRATED);
+            // fall through
+        case STATE_CALIBRATED:
+            assert(m_state == STATE_CALIBRATED);
+            SetState(STATE_GUIDING);
+            pFrame->SetStatusText(_("Guiding..."), 1);
+            pFrame->m_guidingStarted = wxDateTime::UNow();
+            pFrame->m_frameCounter = 0;
+            GuideLog.StartGuiding();
+            EvtServer.NotifyStartGuiding();
+            break;
+        case STATE_GUIDING:
+            if (m_ditherRecenterRemaining.IsValid())
+            {
+                // fast recenter after dither taking large steps and bypassing
+                // guide algorithms (normalMove=false)
 
-                    Debug.AddLine(wxString::Format("dither recenter: remaining=(%.1f,%.1f) step=(%.1f,%.1f)",
-                        m_ditherRecenterRemaining.X * m_ditherRecenterDir.x,
-                        m_ditherRecenterRemaining.Y * m_ditherRecenterDir.y,
-                        step.X * m_ditherRecenterDir.x, step.Y * m_ditherRecenterDir.y));
+                wxCriticalSectionLocker lock(m_analysisLock);
 
-                    m_ditherRecenterRemaining -= step;
-                    if (m_ditherRecenterRemaining.X < 0.5 && m_ditherRecenterRemaining.Y < 0.5)
-                    {
-                        // fast recenter is done
-                        m_ditherRecenterRemaining.Invalidate();
-                        // reset distance tracker
-                        m_avgDistanceNeedReset = true;
-                    }
+                PHD_Point step(wxMin(m_ditherRecenterRemaining.X, m_ditherRecenterStep.X),
+                               wxMin(m_ditherRecenterRemaining.Y, m_ditherRecenterStep.Y));
 
-                    PHD_Point mountCoords(step.X * m_ditherRecenterDir.x, step.Y * m_ditherRecenterDir.y);
-                    PHD_Point cameraCoords;
-                    pMount->TransformMountCoordinatesToCameraCoordinates(mountCoords, cameraCoords);
-                    pFrame->SchedulePrimaryMove(pMount, cameraCoords, false);
-                }
-                else
+                Debug.AddLine(wxString::Format("dither recenter: remaining=(%.1f,%.1f) step=(%.1f,%.1f)",
+                    m_ditherRecenterRemaining.X * m_ditherRecenterDir.x,
+                    m_ditherRecenterRemaining.Y * m_ditherRecenterDir.y,
+                    step.X * m_ditherRecenterDir.x, step.Y * m_ditherRecenterDir.y));
+
+                m_ditherRecenterRemaining -= step;
+                if (m_ditherRecenterRemaining.X < 0.5 && m_ditherRecenterRemaining.Y < 0.5)
                 {
-                    // ordinary guide step
-                    s_deflectionLogger.Log(CurrentPosition());
-                    pFrame->SchedulePrimaryMove(pMount, CurrentPosition() - LockPosition());
+                    // fast recenter is done
+                    m_ditherRecenterRemaining.Invalidate();
+                    // reset distance tracker
+                    m_avgDistanceNeedReset = true;
                 }
-                break;
 
-            case STATE_UNINITIALIZED:
-            case STATE_STOP:
-                break;
-        }
+                PHD_Point mountCoords(step.X * m_ditherRecenterDir.x, step.Y * m_ditherRecenterDir.y);
+                PHD_Point cameraCoords;
+                pMount->TransformMountCoordinatesToCameraCoordinates(mountCoords, cameraCoords);
+                pFrame->SchedulePrimaryMove(pMount, cameraCoords, false);
+            }
+            else
+            {
+                // ordinary guide step, from this frame's star even if the
+                // processing thread has moved on to the next frame
+                s_deflectionLogger.Log(star);
+                pFrame->SchedulePrimaryMove(pMount, star - LockPosition());
+            }
+            break;
+
+        case STATE_UNINITIALIZED:
+        case STATE_STOP:
+            break;
     }
-    catch (wxString Msg)
+}
+
+/*
+ * m_analysisLock is not held across the state machine: the analysis result
+ * comes with the frame, and the few steps that change state the processing
+ * thread reads take the lock themselves. Painting, the star lost flash and
+ * event notifications never wait for an analysis to finish.
+ */
+void Guider::UpdateGuideState(usImage *pImage, bool bStopping)
+{
+    wxString statusMessage;
+
+    // was the frame analysed on the processing thread?
+    const FrameAnalysis *analysis = pImage ? pImage->ImgAnalysis : NULL;
+
+    Debug.Write(wxString::Format("UpdateGuideState(): m_state=%d analyzed=%d\n", m_state, analysis != NULL));
+
+    if (pImage)
     {
-        POSSIBLY_UNUSED(Msg);
+        // switch in the new image
+
+        usImage *pPrevImage = m_pCurrentImage;
+        m_pCurrentImage = pImage;
+        delete pPrevImage;
+    }
+    else
+    {
+        pImage = m_pCurrentImage;
     }
 
+    AdvanceGuideState(pImage, bStopping, analysis, &statusMessage);
+
     // during calibration, the mount is responsible for updating the status message
     if (m_state != STATE_CALIBRATING_PRIMARY && m_state != STATE_CALIBRATING_SECONDARY)
     {
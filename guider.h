@@ -97,6 +97,17 @@ struct OverlaySlitCoords
     wxPoint corners[5];
 };
 
+// what Guider::AnalyzeFrame found in a frame; it travels with the frame
+// (usImage::ImgAnalysis) to UpdateGuideState
+struct FrameAnalysis
+{
+    bool lost;              // the star was not found
+    PHD_Point star;         // guide position found in this frame
+    double mass;            // of the star found in this frame
+    double snr;
+    FrameDroppedInfo info;
+};
+
 enum MOVE_LOCK_RESULT
 {
     MOVE_LOCK_OK,
@@ -157,6 +168,11 @@ class Guider : public wxWindow
     LockPosShiftParams m_lockPosShift;
 
 protected:
+    // Held by the processing thread while it analyses a frame. The main
+    // thread takes it around changes to the guider state, star position and
+    // lock position so they do not happen part way through an analysis.
+    wxCriticalSection m_analysisLock;
+
     bool m_forceFullFrame;
     double m_scaleFactor;
     bool m_showBookmarks;
@@ -229,6 +245,8 @@ public:
 
     void StartGuiding(void);
     void StopGuiding(void);
+    void AnalyzeFrame(usImage *pImage);
+    bool IsAnalyzedFrame(const usImage *pImage);
     void UpdateGuideState(usImage *pImage, bool bStopping=false);
 
     bool SetScaleImage(bool newScaleValue);
@@ -285,6 +303,7 @@ public:
 
 private:
     void UpdateLockPosShiftCameraCoords(void);
+    void AdvanceGuideState(usImage *pImage, bool bStopping, const FrameAnalysis *analysis, wxString *statusMessage);
     DECLARE_EVENT_TABLE()
 };
 
@@ -0,0 +1,557 @@
+/*
+ *  guider_multistar.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2016 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "phd.h"
+#include <algorithm>
+
+static const bool DefaultMultiStarEnabled = false;
+static const int DefaultMaxStars = 9;
+enum { MIN_MAX_STARS = 2, MAX_MAX_STARS = 16 };
+
+// star position estimates further than this many MADs from the median are
+// not used. The floor keeps ordinary seeing differences from being rejected
+// when the stars happen to agree very closely on a frame.
+static const double OutlierMADs = 3.0;
+static const double MinOutlierPx = 0.5;
+
+// Centroids the secondary stars of a frame in parallel. The calling thread
+// takes a share of the stars so a frame costs one wakeup per worker.
+class CentroidPool
+{
+    class Worker : public wxThread
+    {
+        CentroidPool *m_pool;
+        unsigned int m_slot;
+        unsigned int m_seen;    // generation of the last job taken
+
+    public:
+        Worker(CentroidPool *pool, unsigned int slot, unsigned int generation)
+            : wxThread(wxTHREAD_JOINABLE), m_pool(pool), m_slot(slot), m_seen(generation) { }
+        ExitCode Entry(void);
+    };
+
+    wxMutex m_lock;
+    wxCondition m_workAvailable;
+    wxCondition m_workDone;
+    std::vector<Worker *> m_workers;
+    unsigned int m_generation;
+    unsigned int m_busy;
+    bool m_shutdown;
+
+    // current job
+    const usImage *m_pImage;
+    std::vector<GuideStar> *m_pStars;
+    PHD_Point m_primaryPos;
+    int m_searchRegion;
+    Star::FindMode m_findMode;
+
+    void FindSlot(unsigned int slot);
+
+public:
+    CentroidPool(unsigned int numWorkers);
+    ~CentroidPool(void);
+
+    void FindStars(const usImage *pImage, std::vector<GuideStar>& stars, const PHD_Point& primaryPos,
+                   int searchRegion, Star::FindMode mode);
+};
+
+CentroidPool::CentroidPool(unsigned int numWorkers)
+    : m_workAvailable(m_lock),
+      m_workDone(m_lock),
+      m_generation(0),
+      m_busy(0),
+      m_shutdown(false),
+      m_pImage(0),
+      m_pStars(0),
+      m_searchRegion(0),
+      m_findMode(Star::FIND_CENTROID)
+{
+    for (unsigned int i = 0; i < numWorkers; i++)
+    {
+        // the worker must wait for the job after the current generation,
+        // whenever its thread gets to run
+        unsigned int generation;
+        {
+            wxMutexLocker lock(m_lock);
+            generation = m_generation;
+        }
+
+        Worker *worker = new Worker(this, i + 1, generation);
+        if (worker->Create() != wxTHREAD_NO_ERROR || worker->Run() != wxTHREAD_NO_ERROR)
+        {
+            Debug.AddLine("CentroidPool: could not start worker thread %u", i);
+            delete worker;
+            break;
+        }
+        m_workers.push_back(worker);
+    }
+
+    Debug.AddLine("CentroidPool: started %u worker threads", (unsigned int) m_workers.size());
+}
+
+CentroidPool::~CentroidPool(void)
+{
+    {
+        wxMutexLocker lock(m_lock);
+        m_shutdown = true;
+        m_workAvailable.Broadcast();
+    }
+
+    for (unsigned int i = 0; i < m_workers.size(); i++)
+    {
+        m_workers[i]->Wait();
+        delete m_workers[i];
+    }
+}
+
+wxThread::ExitCode CentroidPool::Worker::Entry(void)
+{
+    wxMutexLocker lock(m_pool->m_lock);
+
+    while (true)
+    {
+        while (m_pool->m_generation == m_seen && !m_pool->m_shutdown)
+            m_pool->m_workAvailable.Wait();
+
+        if (m_pool->m_shutdown)
+            break;
+
+        m_seen = m_pool->m_generation;
+
+        m_pool->m_lock.Unlock();
+        m_pool->FindSlot(m_slot);
+        m_pool->m_lock.Lock();
+
+        if (--m_pool->m_busy == 0)
+            m_pool->m_workDone.Signal();
+    }
+
+    return 0;
+}
+
+void CentroidPool::FindSlot(unsigned int slot)
+{
+    std::vector<GuideStar>& stars = *m_pStars;
+    unsigned int const stride = m_workers.size() + 1;
+
+    for (unsigned int i = slot; i < stars.size(); i += stride)
+    {
+        GuideStar& gs = stars[i];
+        PHD_Point predicted = m_primaryPos + gs.offset;
+
+        Star newStar(gs.star);
+        newStar.Find(m_pImage, m_searchRegion, ROUND(predicted.X), ROUND(predicted.Y), m_findMode);
+
+        gs.found = newStar.WasFound() && newStar.GetError() != Star::STAR_SATURATED;
+        if (gs.found)
+            gs.star = newStar;
+        else
+            gs.star.SetError(newStar.GetError());
+    }
+}
+
+void CentroidPool::FindStars(const usImage *pImage, std::vector<GuideStar>& stars, const PHD_Point& primaryPos,
+                             int searchRegion, Star::FindMode mode)
+{
+    m_pImage = pImage;
+    m_pStars = &stars;
+    m_primaryPos = primaryPos;
+    m_searchRegion = searchRegion;
+    m_findMode = mode;
+
+    bool const parallel = !m_workers.empty() && stars.size() > 1;
+
+    if (parallel)
+    {
+        wxMutexLocker lock(m_lock);
+        m_busy = m_workers.size();
+        ++m_generation;
+        m_workAvailable.Broadcast();
+    }
+
+    FindSlot(0);
+
+    if (parallel)
+    {
+        wxMutexLocker lock(m_lock);
+        while (m_busy > 0)
+            m_workDone.Wait();
+    }
+}
+
+static unsigned int PoolSize(void)
+{
+    // leave a core for the UI and camera threads, and do not bother with
+    // more than a few workers: each star is only a small window of pixels
+    int cpus = wxThread::GetCPUCount();
+    if (cpus <= 1)
+        return 0;
+    return wxMin(cpus - 1, 3);
+}
+
+GuiderMultiStar::GuiderMultiStar(wxWindow *parent)
+    : GuiderOneStar(parent),
+      m_pool(new CentroidPool(PoolSize())),
+      m_multiStarEnabled(DefaultMultiStarEnabled),
+      m_maxStars(DefaultMaxStars)
+{
+}
+
+GuiderMultiStar::~GuiderMultiStar(void)
+{
+    delete m_pool;
+}
+
+void GuiderMultiStar::LoadProfileSettings(void)
+{
+    GuiderOneStar::LoadProfileSettings();
+
+    bool multiStarEnabled = pConfig->Profile.GetBoolean("/guider/multistar/Enabled", DefaultMultiStarEnabled);
+    SetMultiStarEnabled(multiStarEnabled);
+
+    int maxStars = pConfig->Profile.GetInt("/guider/multistar/MaxStars", DefaultMaxStars);
+    SetMaxStars(maxStars);
+}
+
+bool GuiderMultiStar::GetMultiStarEnabled(void)
+{
+    return m_multiStarEnabled;
+}
+
+void GuiderMultiStar::SetMultiStarEnabled(bool enable)
+{
+    if (enable != m_multiStarEnabled)
+    {
+        // the secondary stars are only selected along with the primary star
+        ClearSecondaryStars();
+    }
+
+    m_multiStarEnabled = enable;
+    pConfig->Profile.SetBoolean("/guider/multistar/Enabled", enable);
+}
+
+int GuiderMultiStar::GetMaxStars(void)
+{
+    return m_maxStars;
+}
+
+bool GuiderMultiStar::SetMaxStars(int maxStars)
+{
+    bool bError = false;
+
+    try
+    {
+        if (maxStars < MIN_MAX_STARS)
+        {
+            throw ERROR_INFO("maxStars < MIN_MAX_STARS");
+        }
+
+        if (maxStars > MAX_MAX_STARS)
+        {
+            throw ERROR_INFO("maxStars > MAX_MAX_STARS");
+        }
+
+        m_maxStars = maxStars;
+    }
+    catch (wxString Msg)
+    {
+        POSSIBLY_UNUSED(Msg);
+        bError = true;
+        m_maxStars = DefaultMaxStars;
+    }
+
+    pConfig->Profile.SetInt("/guider/multistar/MaxStars", m_maxStars);
+
+    return bError;
+}
+
+void GuiderMultiStar::ClearSecondaryStars(void)
+{
+    wxCriticalSectionLocker lock(m_analysisLock);
+
+    m_secondaryStars.clear();
+    m_combinedPosition.Invalidate();
+}
+
+void GuiderMultiStar::SelectSecondaryStars(const usImage *pImage)
+{
+    wxCriticalSectionLocker lock(m_analysisLock);
+
+    ClearSecondaryStars();
+
+    if (!m_multiStarEnabled)
+        return;
+
+    const PHD_Point& primary = GuiderOneStar::CurrentPosition();
+    if (!primary.IsValid())
+        return;
+
+    // the primary star is usually among the stars found; it is skipped below
+    std::vector<Star> stars;
+    if (!Star::AutoFindStars(*pImage, 0, GetSearchRegion(), m_maxStars, &stars))
+    {
+        Debug.AddLine("MultiStar: no secondary stars found");
+        return;
+    }
+
+    // stars closer than this to each other would be captured by each other's
+    // search regions
+    double const minSep = 2.0 * GetSearchRegion();
+
+    for (std::vector<Star>::const_iterator it = stars.begin(); it != stars.end() && m_secondaryStars.size() + 1 < (unsigned int) m_maxStars; ++it)
+    {
+        if (it->Distance(primary) < minSep)
+            continue;
+
+        GuideStar gs;
+        gs.star = *it;
+        gs.offset = *it - primary;
+        gs.found = true;
+        m_secondaryStars.push_back(gs);
+    }
+
+    m_combinedPosition = primary;
+
+    Debug.AddLine("MultiStar: selected %u secondary stars", (unsigned int) m_secondaryStars.size());
+}
+
+bool GuiderMultiStar::AutoSelect(void)
+{
+    bool bError = GuiderOneStar::AutoSelect();
+
+    if (!bError)
+    {
+        SelectSecondaryStars(CurrentImage());
+    }
+
+    return bError;
+}
+
+bool GuiderMultiStar::SetCurrentPosition(usImage *pImage, const PHD_Point& position)
+{
+    bool bError = GuiderOneStar::SetCurrentPosition(pImage, position);
+
+    if (bError)
+    {
+        ClearSecondaryStars();
+    }
+    else
+    {
+        SelectSecondaryStars(pImage);
+    }
+
+    return bError;
+}
+
+void GuiderMultiStar::InvalidateCurrentPosition(bool fullReset)
+{
+    GuiderOneStar::InvalidateCurrentPosition(fullReset);
+    ClearSecondaryStars();
+}
+
+inline static double Median(std::vector<double>& v)
+{
+    size_t const mid = v.size() / 2;
+    std::nth_element(v.begin(), v.begin() + mid, v.end());
+    double m = v[mid];
+    if (v.size() % 2 == 0)
+        m = (m + *std::max_element(v.begin(), v.begin() + mid)) / 2.0;
+    return m;
+}
+
+void GuiderMultiStar::CombineStarPositions(void)
+{
+    const PHD_Point& primary = GuiderOneStar::CurrentPosition();
+
+    // each star gives an estimate of the primary star position
+    std::vector<PHD_Point> pos;
+    std::vector<double> weight;
+
+    pos.push_back(primary);
+    weight.push_back(GuiderOneStar::SNR());
+
+    for (std::vector<GuideStar>::const_iterator it = m_secondaryStars.begin(); it != m_secondaryStars.end(); ++it)
+    {
+        if (!it->found)
+            continue;
+        pos.push_back(it->star - it->offset);
+        weight.push_back(it->star.SNR);
+    }
+
+    std::vector<bool> use(pos.size(), true);
+
+    if (pos.size() >= 3)
+    {
+        std::vector<double> x, y;
+        for (unsigned int i = 0; i < pos.size(); i++)
+        {
+            x.push_back(pos[i].X);
+            y.push_back(pos[i].Y);
+        }
+        PHD_Point med(Median(x), Median(y));
+
+        std::vector<double> resid;
+        for (unsigned int i = 0; i < pos.size(); i++)
+            resid.push_back(pos[i].Distance(med));
+        std::vector<double> tmp(resid);
+        double mad = Median(tmp);
+
+        double const limit = wxMax(OutlierMADs * 1.4826 * mad, MinOutlierPx);
+        for (unsigned int i = 0; i < pos.size(); i++)
+            if (resid[i] > limit)
+                use[i] = false;
+    }
+
+    double sumX = 0.0, sumY = 0.0, sumW = 0.0;
+    unsigned int used = 0;
+
+    for (unsigned int i = 0; i < pos.size(); i++)
+    {
+        if (!use[i])
+            continue;
+        double const w = wxMax(weight[i], 1.0);
+        sumX += w * pos[i].X;
+        sumY += w * pos[i].Y;
+        sumW += w;
+        ++used;
+    }
+
+    m_combinedPosition.SetXY(sumX / sumW, sumY / sumW);
+
+    Debug.AddLine("MultiStar: used %u of %u stars, primary (%.2f, %.2f) combined (%.2f, %.2f)",
+        used, (unsigned int) m_secondaryStars.size() + 1, primary.X, primary.Y, m_combinedPosition.X, m_combinedPosition.Y);
+}
+
+bool GuiderMultiStar::UpdateCurrentPosition(usImage *pImage, FrameDroppedInfo *errorInfo)
+{
+    // the primary star still decides whether the frame is usable
+    bool bError = GuiderOneStar::UpdateCurrentPosition(pImage, errorInfo);
+
+    if (bError || m_secondaryStars.empty())
+    {
+        m_combinedPosition.Invalidate();
+        return bError;
+    }
+
+    m_pool->FindStars(pImage, m_secondaryStars, GuiderOneStar::CurrentPosition(), GetSearchRegion(),
+        pFrame->GetStarFindMode());
+
+    CombineStarPositions();
+
+    const PHD_Point& lockPos = LockPosition();
+    if (lockPos.IsValid())
+    {
+        UpdateCurrentDistance(m_combinedPosition.Distance(lockPos));
+    }
+
+    return false;
+}
+
+const PHD_Point& GuiderMultiStar::CurrentPosition(void)
+{
+    if (m_combinedPosition.IsValid())
+        return m_combinedPosition;
+    return GuiderOneStar::CurrentPosition();
+}
+
+wxRect GuiderMultiStar::GetBoundingBox(void)
+{
+    // the secondary stars are spread over the whole frame, so subframes can
+    // only be used when guiding on a single star
+    if (!m_secondaryStars.empty())
+        return wxRect(0, 0, 0, 0);
+
+    return GuiderOneStar::GetBoundingBox();
+}
+
+wxString GuiderMultiStar::GetSettingsSummary()
+{
+    wxString s = GuiderOneStar::GetSettingsSummary();
+
+    if (GetMultiStarEnabled())
+        s += wxString::Format(_T("Multi-star guiding = enabled, max stars = %d\n"), GetMaxStars());
+    else
+        s += _T("Multi-star guiding = disabled\n");
+
+    return s;
+}
+
+ConfigDialogPane *GuiderMultiStar::GetConfigDialogPane(wxWindow *pParent)
+{
+    return new GuiderMultiStarConfigDialogPane(pParent, this);
+}
+
+GuiderMultiStar::GuiderMultiStarConfigDialogPane::GuiderMultiStarConfigDialogPane(wxWindow *pParent, GuiderMultiStar *pGuider)
+    : GuiderOneStarConfigDialogPane(pParent, pGuider)
+{
+    m_pGuiderMultiStar = pGuider;
+
+    m_pEnableMultiStar = new wxCheckBox(pParent, MULTISTAR_ENABLE, _("Use multiple stars"));
+    DoAdd(m_pEnableMultiStar, _("Check to guide on several stars at once. The offsets of the secondary stars are "
+        "averaged with the guide star to reduce the effect of seeing. Full frames are always downloaded when this is enabled."));
+
+    pParent->Bind(wxEVT_COMMAND_CHECKBOX_CLICKED, &GuiderMultiStar::GuiderMultiStarConfigDialogPane::OnMultiStarEnableChecked, this, MULTISTAR_ENABLE);
+
+    int width = StringWidth(_T("000"));
+    m_pMaxStars = new wxSpinCtrl(pParent, wxID_ANY, _T("foo2"), wxPoint(-1,-1),
+        wxSize(width+30, -1), wxSP_ARROW_KEYS, MIN_MAX_STARS, MAX_MAX_STARS, DefaultMaxStars, _T("MaxStars"));
+    DoAdd(_("Maximum stars"), m_pMaxStars,
+          wxString::Format(_("Maximum number of stars, including the guide star, to use for multi-star guiding. Default = %d"), DefaultMaxStars));
+}
+
+GuiderMultiStar::GuiderMultiStarConfigDialogPane::~GuiderMultiStarConfigDialogPane(void)
+{
+}
+
+void GuiderMultiStar::GuiderMultiStarConfigDialogPane::LoadValues(void)
+{
+    GuiderOneStarConfigDialogPane::LoadValues();
+
+    bool multiStarEnabled = m_pGuiderMultiStar->GetMultiStarEnabled();
+    m_pEnableMultiStar->SetValue(multiStarEnabled);
+    m_pMaxStars->Enable(multiStarEnabled);
+    m_pMaxStars->SetValue(m_pGuiderMultiStar->GetMaxStars());
+}
+
+void GuiderMultiStar::GuiderMultiStarConfigDialogPane::UnloadValues(void)
+{
+    m_pGuiderMultiStar->SetMaxStars(m_pMaxStars->GetValue());
+    m_pGuiderMultiStar->SetMultiStarEnabled(m_pEnableMultiStar->GetValue());
+
+    GuiderOneStarConfigDialogPane::UnloadValues();
+}
+
+void GuiderMultiStar::GuiderMultiStarConfigDialogPane::OnMultiStarEnableChecked(wxCommandEvent& event)
+{
+    m_pMaxStars->Enable(event.IsChecked());
+}
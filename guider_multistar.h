@@ -0,0 +1,115 @@
+/*
+ *  guider_multistar.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2016 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef GUIDER_MULTISTAR_H_INCLUDED
+#define GUIDER_MULTISTAR_H_INCLUDED
+
+class CentroidPool;
+
+// A secondary guide star. The offset from the primary star is recorded
+// when the star is selected so each star gives an independent estimate
+// of where the primary star is on later frames.
+struct GuideStar
+{
+    Star star;
+    PHD_Point offset;   // star position - primary star position at selection time
+    bool found;         // found on the current frame
+};
+
+class GuiderMultiStar : public GuiderOneStar
+{
+private:
+    std::vector<GuideStar> m_secondaryStars;
+    PHD_Point m_combinedPosition;
+    CentroidPool *m_pool;
+
+    // parameters
+    bool m_multiStarEnabled;
+    int m_maxStars;
+
+protected:
+    class GuiderMultiStarConfigDialogPane : public GuiderOneStarConfigDialogPane
+    {
+        GuiderMultiStar *m_pGuiderMultiStar;
+        wxCheckBox *m_pEnableMultiStar;
+        wxSpinCtrl *m_pMaxStars;
+
+        public:
+        GuiderMultiStarConfigDialogPane(wxWindow *pParent, GuiderMultiStar *pGuider);
+        ~GuiderMultiStarConfigDialogPane(void);
+
+        virtual void LoadValues(void);
+        virtual void UnloadValues(void);
+
+        void OnMultiStarEnableChecked(wxCommandEvent& event);
+    };
+
+    virtual bool GetMultiStarEnabled(void);
+    virtual void SetMultiStarEnabled(bool enable);
+    virtual int GetMaxStars(void);
+    virtual bool SetMaxStars(int maxStars);
+
+    friend class GuiderMultiStarConfigDialogPane;
+
+public:
+    GuiderMultiStar(wxWindow *parent);
+    virtual ~GuiderMultiStar(void);
+
+    virtual bool AutoSelect(void);
+    virtual const PHD_Point& CurrentPosition(void);
+    virtual wxRect GetBoundingBox(void);
+    virtual wxString GetSettingsSummary();
+
+    virtual ConfigDialogPane *GetConfigDialogPane(wxWindow *pParent);
+
+    virtual void LoadProfileSettings(void);
+
+    unsigned int SecondaryStarCount(void) const;
+
+protected:
+    virtual void InvalidateCurrentPosition(bool fullReset = false);
+    virtual bool UpdateCurrentPosition(usImage *pImage, FrameDroppedInfo *errorInfo);
+    virtual bool SetCurrentPosition(usImage *pImage, const PHD_Point& position);
+
+private:
+    void SelectSecondaryStars(const usImage *pImage);
+    void ClearSecondaryStars(void);
+    void CombineStarPositions(void);
+};
+
+inline unsigned int GuiderMultiStar::SecondaryStarCount(void) const
+{
+    return m_secondaryStars.size();
+}
+
+#endif /* GUIDER_MULTISTAR_H_INCLUDED */
@@ -141,6 +141,101 @@ public:
     }
 };
 
+// Predicts where the star will be on the next frame with an alpha-beta
+// (constant velocity) filter, and sizes the star search window from how well
+// the recent predictions matched the measured positions.
+class StarMotionPredictor
+{
+    // filter gains for position and velocity
+    static const double Alpha;
+    static const double Beta;
+    // weight of the newest frame in the smoothed prediction error
+    static const double ErrorWeight;
+
+    enum
+    {
+        MIN_TRACK_FRAMES = 4,   // use the full search region until the track settles
+        CENTROID_MARGIN = 8,    // room for the centroid window around the star
+        ERROR_SIGMAS = 4,
+    };
+
+    PHD_Point m_pos;
+    double m_vx;                // pixels per frame
+    double m_vy;
+    double m_errSq;             // smoothed squared prediction error
+    unsigned int m_frames;
+
+public:
+
+    StarMotionPredictor()
+    {
+        Reset();
+    }
+
+    void Reset(void)
+    {
+        m_pos.Invalidate();
+        m_vx = m_vy = 0.0;
+        m_errSq = 0.0;
+        m_frames = 0;
+    }
+
+    bool IsValid(void) const
+    {
+        return m_pos.IsValid();
+    }
+
+    PHD_Point Predict(void) const
+    {
+        return PHD_Point(m_pos.X + m_vx, m_pos.Y + m_vy);
+    }
+
+    double PredictionError(void) const
+    {
+        return sqrt(m_errSq);
+    }
+
+    void Update(const PHD_Point& measured)
+    {
+        if (!m_pos.IsValid())
+        {
+            m_pos = measured;
+            m_frames = 1;
+            return;
+        }
+
+        double px = m_pos.X + m_vx;
+        double py = m_pos.Y + m_vy;
+        double rx = measured.X - px;
+        double ry = measured.Y - py;
+
+        m_pos.SetXY(px + Alpha * rx, py + Alpha * ry);
+        m_vx += Beta * rx;
+        m_vy += Beta * ry;
+
+        double errSq = rx * rx + ry * ry;
+        if (m_frames == 1)
+            m_errSq = errSq;
+        else
+            m_errSq += ErrorWeight * (errSq - m_errSq);
+
+        ++m_frames;
+    }
+
+    int SearchRegion(int maxSearchRegion) const
+    {
+        if (m_frames < MIN_TRACK_FRAMES)
+            return maxSearchRegion;
+
+        int region = CENTROID_MARGIN + (int) ceil(ERROR_SIGMAS * PredictionError());
+        return wxMin(region, maxSearchRegion);
+    }
+};
+
+const double StarMotionPredictor::Alpha = 0.5;
+const double StarMotionPredictor::Beta = 0.1;
+const double StarMotionPredictor::ErrorWeight = 0.2;
+
 static const double DefaultMassChangeThreshold = 0.5;
 
 enum {
@@ -157,14 +252,20 @@ END_EVENT_TABLE()
 // Define a constructor for the guide canvas
 GuiderOneStar::GuiderOneStar(wxWindow *parent)
     : Guider(parent, XWinSize, YWinSize),
-      m_massChecker(new MassChecker())
+      m_massChecker(new MassChecker()),
+      m_predictor(new StarMotionPredictor()),
+      m_catalog(new StarCatalog()),
+      m_searchRegion(DEFAULT_SEARCH_REGION)
 {
+    ResetRoi();
     SetState(STATE_UNINITIALIZED);
 }
 
 GuiderOneStar::~GuiderOneStar()
 {
     delete m_massChecker;
+    delete m_predictor;
+    delete m_catalog;
 }
 
 void GuiderOneStar::LoadProfileSettings(void)
@@ -250,11 +351,14 @@ bool GuiderOneStar::SetSearchRegion(int searchRegion)
 
     pConfig->Profile.SetInt("/guider/onestar/SearchRegion", m_searchRegion);
 
+    ResetRoi();
+
     return bError;
 }
 
 bool GuiderOneStar::SetCurrentPosition(usImage *pImage, const PHD_Point& position)
 {
+    wxCriticalSectionLocker lock(m_analysisLock);
     bool bError = true;
 
     try
@@ -280,6 +384,8 @@ bool GuiderOneStar::SetCurrentPosition(usImage *pImage, const PHD_Point& positio
         }
 
         m_massChecker->Reset();
+        m_predictor->Reset();
+        ResetRoi();
         bError = !m_star.Find(pImage, m_searchRegion, x, y, pFrame->GetStarFindMode());
     }
     catch (wxString Msg)
@@ -335,7 +441,7 @@ static void SaveAutoSelectFailedImg(usImage *pImage)
 
     Debug.AddLine("GuiderOneStar::AutoSelect failed. Saving image to " + filename);
 
-    pImage->Save(wxFileName(Debug.GetLogDir(), filename).GetFullPath());
+    ImgWriter.Save(*pImage, wxFileName(Debug.GetLogDir(), filename).GetFullPath());
 }
 
 bool GuiderOneStar::AutoSelect(void)
@@ -361,13 +467,18 @@ bool GuiderOneStar::AutoSelect(void)
         if (pSecondaryMount && pSecondaryMount->IsConnected() && !pSecondaryMount->IsCalibrated())
             edgeAllowance = wxMax(edgeAllowance, pSecondaryMount->CalibrationTotDistance());
 
+        // use the background star catalog if it is recent enough, otherwise
+        // scan the frame
         Star newStar;
-        if (!newStar.AutoFind(*pImage, edgeAllowance, m_searchRegion))
+        if (!m_catalog->FindBestStar(*pImage, edgeAllowance, m_searchRegion, &newStar) &&
+            !newStar.AutoFind(*pImage, edgeAllowance, m_searchRegion))
         {
             throw ERROR_INFO("Unable to AutoFind");
         }
 
         m_massChecker->Reset();
+        m_predictor->Reset();
+        ResetRoi();
 
         if (!m_star.Find(pImage, m_searchRegion, newStar.X, newStar.Y, Star::FIND_CENTROID))
         {
@@ -426,6 +537,44 @@ const PHD_Point& GuiderOneStar::CurrentPosition(void)
     return m_star;
 }
 
+void GuiderOneStar::ResetRoi(void)
+{
+    m_starExcursion = 0.0;
+    m_roiHalfWidth = m_searchRegion;
+    m_roiShrinkFrames = 0;
+}
+
+// Size the subframe from how far the star has recently strayed from the lock
+// position plus the window the star search needs around the predicted
+// position. The subframe grows as soon as it needs to, e.g. after a dither,
+// but only shrinks after the star has been steady for a few frames so that
+// the camera is not asked for a different subframe on every exposure.
+int GuiderOneStar::AdaptiveRoiHalfWidth(void)
+{
+    enum
+    {
+        ROI_STEP = 4,
+        ROI_SHRINK_FRAMES = 5,
+    };
+
+    int want = m_predictor->SearchRegion(m_searchRegion) + (int) ceil(m_starExcursion);
+    want = (want + ROI_STEP - 1) / ROI_STEP * ROI_STEP;
+    want = wxMin(want, 2 * m_searchRegion);
+
+    if (want >= m_roiHalfWidth)
+    {
+        m_roiHalfWidth = want;
+        m_roiShrinkFrames = 0;
+    }
+    else if (++m_roiShrinkFrames >= ROI_SHRINK_FRAMES)
+    {
+        m_roiHalfWidth = want;
+        m_roiShrinkFrames = 0;
+    }
+
+    return m_roiHalfWidth;
+}
+
 inline static wxRect SubframeRect(const PHD_Point& pos, int halfwidth)
 {
     return wxRect(ROUND(pos.X - halfwidth),
@@ -472,8 +621,22 @@ wxRect GuiderOneStar::GetBoundingBox(void)
 
     if (subframe)
     {
-        wxRect box(SubframeRect(pos, m_searchRegion + SUBFRAME_BOUNDARY_PX));
+        // readout time only depends on the subframe size when the camera
+        // really reads out a subframe
+        int halfwidth = m_searchRegion;
+        if (pCamera->HasSubframes && pCamera->UseSubframes)
+            halfwidth = AdaptiveRoiHalfWidth();
+
+        wxRect box(SubframeRect(pos, halfwidth + SUBFRAME_BOUNDARY_PX));
         box.Intersect(wxRect(0, 0, pCamera->FullSize.x, pCamera->FullSize.y));
+
+        if (box.GetSize() != m_lastRoiSize)
+        {
+            Debug.AddLine("GetBoundingBox: ROI size %dx%d", box.GetWidth(), box.GetHeight());
+            GuideLog.NotifyGuideROI(box);
+            m_lastRoiSize = box.GetSize();
+        }
+
         return box;
     }
     else
@@ -504,11 +667,15 @@ int GuiderOneStar::StarError(void)
 
 void GuiderOneStar::InvalidateCurrentPosition(bool fullReset)
 {
+    wxCriticalSectionLocker lock(m_analysisLock);
+
     m_star.Invalidate();
+    m_predictor->Reset();
 
     if (fullReset)
     {
         m_star.X = m_star.Y = 0.0;
+        m_catalog->Clear();
     }
 }
 
@@ -527,78 +694,220 @@ static wxString StarStatusStr(const Star& star)
     }
 }
 
-bool GuiderOneStar::UpdateCurrentPosition(usImage *pImage, FrameDroppedInfo *errorInfo)
+enum
 {
-    if (!m_star.IsValid() && m_star.X == 0.0 && m_star.Y == 0.0)
+    REACQUIRE_SEARCH_SCALE = 3,     // wide search is this many times the search region
+    REACQUIRE_TOLERANCE_PX = 3,
+    REACQUIRE_CONFIRM_STARS = 2,
+    REACQUIRE_MAX_AGE_MS = 600000,
+};
+
+// Look for the lost guide star in a wider area around its last position. A
+// star found there may be the guide star or one of its neighbors, so each
+// catalog star near the last position is tried as the match, smallest field
+// shift first, and the guide star is accepted where that shift also puts
+// another catalog star.
+bool GuiderOneStar::ReacquireStar(const usImage *pImage, Star *newStar)
+{
+    if (pImage->Subframe.GetWidth() > 0)
+        return false;
+
+    std::vector<Star> catalog;
+    if (!m_catalog->GetStars(pImage->Size, REACQUIRE_MAX_AGE_MS, &catalog))
+        return false;
+
+    // the guide star's own catalog entry
+    int guideIdx = -1;
+    double bestDist = m_searchRegion;
+    for (unsigned int i = 0; i < catalog.size(); i++)
     {
-        Debug.AddLine("UpdateCurrentPosition: no star selected");
-        errorInfo->starError = Star::STAR_ERROR;
-        errorInfo->starMass = 0.0;
-        errorInfo->starSNR = 0.0;
-        errorInfo->status = _("No star selected");
-        return true;
+        double d = catalog[i].Distance(m_star);
+        if (d <= bestDist)
+        {
+            bestDist = d;
+            guideIdx = i;
+        }
     }
+    if (guideIdx < 0)
+        return false;
 
-    bool bError = false;
+    Star::FindMode const mode = pFrame->GetStarFindMode();
+    int const wideRegion = REACQUIRE_SEARCH_SCALE * m_searchRegion;
 
-    try
+    Star found(m_star);
+    if (!found.Find(pImage, wideRegion, mode))
+        return false;
+
+    // candidate field shifts, smallest first
+    std::vector<std::pair<double, unsigned int> > matches;
+    for (unsigned int i = 0; i < catalog.size(); i++)
+    {
+        double d = found.Distance(catalog[i]);
+        if (d <= 2 * wideRegion)
+            matches.push_back(std::make_pair(d, i));
+    }
+    std::sort(matches.begin(), matches.end());
+
+    // the other catalog stars nearest the guide star, for confirming a match
+    std::vector<std::pair<double, unsigned int> > neighbors;
+    for (unsigned int i = 0; i < catalog.size(); i++)
     {
-        Star newStar(m_star);
+        if ((int) i != guideIdx)
+            neighbors.push_back(std::make_pair(catalog[i].Distance(catalog[guideIdx]), i));
+    }
+    std::sort(neighbors.begin(), neighbors.end());
 
-        if (!newStar.Find(pImage, m_searchRegion, pFrame->GetStarFindMode()))
+    for (unsigned int m = 0; m < matches.size(); m++)
+    {
+        unsigned int const matchIdx = matches[m].second;
+        PHD_Point shift = found - catalog[matchIdx];
+        PHD_Point target = catalog[guideIdx] + shift;
+
+        Star candidate(m_star);
+        if (!candidate.Find(pImage, m_searchRegion, ROUND(target.X), ROUND(target.Y), mode) ||
+            candidate.Distance(target) > REACQUIRE_TOLERANCE_PX)
         {
-            errorInfo->starError = newStar.GetError();
-            errorInfo->starMass = 0.0;
-            errorInfo->starSNR = 0.0;
-            errorInfo->status = StarStatusStr(newStar);
-            m_star.SetError(newStar.GetError());
-            throw ERROR_INFO("UpdateCurrentPosition():newStar not found");
+            continue;
         }
 
-        // check to see if it seems like the star we just found was the
-        // same as the original star.  We do this by comparing the
-        // mass
-        m_massChecker->SetExposure(pFrame->RequestedExposureDuration());
-        double limits[3];
-        if (m_massChangeThresholdEnabled &&
-            m_massChecker->CheckMass(newStar.Mass, m_massChangeThreshold, limits))
+        bool confirmed = neighbors.empty();
+        unsigned int checked = 0;
+        for (unsigned int n = 0; n < neighbors.size() && checked < REACQUIRE_CONFIRM_STARS && !confirmed; n++)
         {
-            m_star.SetError(Star::STAR_MASSCHANGE);
-            errorInfo->starError = Star::STAR_MASSCHANGE;
-            errorInfo->starMass = newStar.Mass;
-            errorInfo->starSNR = newStar.SNR;
-            errorInfo->status = StarStatusStr(m_star);
-            pFrame->SetStatusText(wxString::Format(_("Mass: %.0f vs %.0f"), newStar.Mass, limits[1]), 1);
-            Debug.Write(wxString::Format("UpdateGuideState(): star mass new=%.1f exp=%.1f thresh=%.0f%% range=(%.1f, %.1f)\n", newStar.Mass, limits[1], m_massChangeThreshold * 100, limits[0], limits[2]));
-            m_massChecker->AppendData(newStar.Mass);
-            throw THROW_INFO("massChangeThreshold error");
+            unsigned int const idx = neighbors[n].second;
+            if (idx == matchIdx)
+                continue;
+
+            PHD_Point pos = catalog[idx] + shift;
+            if (pos.X < 0 || pos.Y < 0 || pos.X >= pImage->Size.GetWidth() || pos.Y >= pImage->Size.GetHeight())
+                continue;
+
+            ++checked;
+
+            Star tmp;
+            if (tmp.Find(pImage, m_searchRegion, ROUND(pos.X), ROUND(pos.Y), Star::FIND_CENTROID) &&
+                tmp.Distance(pos) <= REACQUIRE_TOLERANCE_PX)
+            {
+                confirmed = true;
+            }
         }
 
-        // update the star position, mass, etc.
-        m_star = newStar;
-        m_massChecker->AppendData(newStar.Mass);
+        // with no neighbor in the frame to check against, take the match
+        if (!confirmed && checked > 0)
+            continue;
+
+        Debug.AddLine("ReacquireStar: star found at (%.2f, %.2f), field shift (%.2f, %.2f)",
+            candidate.X, candidate.Y, shift.X, shift.Y);
+        *newStar = candidate;
+        return true;
+    }
+
+    Debug.AddLine("ReacquireStar: no match");
+    return false;
+}
+
+bool GuiderOneStar::UpdateCurrentPosition(usImage *pImage, FrameDroppedInfo *errorInfo)
+{
+    m_catalog->OfferFrame(*pImage, m_searchRegion);
+
+    if (!m_star.IsValid() && m_star.X == 0.0 && m_star.Y == 0.0)
+    {
+        Debug.AddLine("UpdateCurrentPosition: no star selected");
+        errorInfo->starError = Star::STAR_ERROR;
+        errorInfo->starMass = 0.0;
+        errorInfo->starSNR = 0.0;
+        errorInfo->status = _("No star selected");
+        return true;
+    }
 
-        const PHD_Point& lockPos = LockPosition();
-        if (lockPos.IsValid())
+    // a lost star is an ordinary outcome here, so it is reported by the
+    // return value rather than by throwing
+    Star newStar(m_star);
+    bool found;
+
+    // search around the predicted position, in a window sized by how
+    // well the star has been following the prediction. If the star is
+    // not there fall back to the full search region around the last
+    // position.
+    int searchRegion = m_predictor->SearchRegion(m_searchRegion);
+    if (m_predictor->IsValid() && m_star.IsValid())
+    {
+        PHD_Point predicted = m_predictor->Predict();
+        found = newStar.Find(pImage, searchRegion, ROUND(predicted.X), ROUND(predicted.Y), pFrame->GetStarFindMode());
+        if (!found)
         {
-            double distance = newStar.Distance(lockPos);
-            UpdateCurrentDistance(distance);
+            Debug.AddLine("UpdateCurrentPosition: star not found at predicted position, widening search");
+            m_predictor->Reset();
+            newStar = m_star;
+            found = newStar.Find(pImage, m_searchRegion, pFrame->GetStarFindMode());
         }
+    }
+    else
+    {
+        found = newStar.Find(pImage, m_searchRegion, pFrame->GetStarFindMode());
+    }
 
-        pFrame->pProfile->UpdateData(pImage, m_star.X, m_star.Y);
-
-        pFrame->AdjustAutoExposure(m_star.SNR);
+    if (!found && ReacquireStar(pImage, &newStar))
+    {
+        m_massChecker->Reset();
+        m_predictor->Reset();
+        found = true;
+    }
 
-        errorInfo->status.Printf(_T("m=%.0f SNR=%.1f"), m_star.Mass, m_star.SNR);
+    if (!found)
+    {
+        errorInfo->starError = newStar.GetError();
+        errorInfo->starMass = 0.0;
+        errorInfo->starSNR = 0.0;
+        errorInfo->status = StarStatusStr(newStar);
+        m_star.SetError(newStar.GetError());
+        Debug.AddLine("UpdateCurrentPosition(): newStar not found");
+        pFrame->ResetAutoExposure(); // use max exposure duration
+        return true;
     }
-    catch (wxString Msg)
+
+    // check to see if it seems like the star we just found was the
+    // same as the original star.  We do this by comparing the
+    // mass
+    m_massChecker->SetExposure(pFrame->RequestedExposureDuration());
+    double limits[3];
+    if (m_massChangeThresholdEnabled &&
+        m_massChecker->CheckMass(newStar.Mass, m_massChangeThreshold, limits))
     {
-        POSSIBLY_UNUSED(Msg);
-        bError = true;
+        m_star.SetError(Star::STAR_MASSCHANGE);
+        errorInfo->starError = Star::STAR_MASSCHANGE;
+        errorInfo->starMass = newStar.Mass;
+        errorInfo->starSNR = newStar.SNR;
+        errorInfo->status = StarStatusStr(m_star);
+        pFrame->SetStatusText(wxString::Format(_("Mass: %.0f vs %.0f"), newStar.Mass, limits[1]), 1);
+        Debug.Write(wxString::Format("UpdateGuideState(): star mass new=%.1f exp=%.1f thresh=%.0f%% range=(%.1f, %.1f)\n", newStar.Mass, limits[1], m_massChangeThreshold * 100, limits[0], limits[2]));
+        m_massChecker->AppendData(newStar.Mass);
+        Debug.AddLine("UpdateCurrentPosition(): massChangeThreshold error");
         pFrame->ResetAutoExposure(); // use max exposure duration
+        return true;
     }
 
-    return bError;
+    // update the star position, mass, etc.
+    m_star = newStar;
+    m_massChecker->AppendData(newStar.Mass);
+    m_predictor->Update(newStar);
+
+    const PHD_Point& lockPos = LockPosition();
+    if (lockPos.IsValid())
+    {
+        double distance = newStar.Distance(lockPos);
+        UpdateCurrentDistance(distance);
+
+        // decaying maximum of the star's distance from the lock position,
+        // for sizing the subframe
+        m_starExcursion = wxMax(distance, m_starExcursion * 0.9);
+    }
+
+    pFrame->AdjustAutoExposure(m_star.SNR);
+
+    errorInfo->status.Printf(_T("m=%.0f SNR=%.1f"), m_star.Mass, m_star.SNR);
+
+    return false;
 }
 
 bool GuiderOneStar::IsValidLockPosition(const PHD_Point& pt)
@@ -801,29 +1110,21 @@ void GuiderOneStar::OnPaint(wxPaintEvent& event)
     }
 }
 
-void GuiderOneStar::SaveStarFITS()
+// the star image logged on each frame, written by the ImageWriter thread
+class StarFitsJob : public ImageWriteJob
 {
-    double StarX = m_star.X;
-    double StarY = m_star.Y;
-    usImage *pImage = CurrentImage();
-    usImage tmpimg;
+    int m_startX;
+    int m_startY;
 
-    tmpimg.Init(60,60);
-    int start_x = ROUND(StarX)-30;
-    int start_y = ROUND(StarY)-30;
-    if ((start_x + 60) > pImage->Size.GetWidth())
-        start_x = pImage->Size.GetWidth() - 60;
-    if ((start_y + 60) > pImage->Size.GetHeight())
-        start_y = pImage->Size.GetHeight() - 60;
-    int x,y, width;
-    width = pImage->Size.GetWidth();
-    unsigned short *usptr = tmpimg.ImageData;
-    for (y=0; y<60; y++)
-        for (x=0; x<60; x++, usptr++)
-            *usptr = *(pImage->ImageData + (y+start_y)*width + (x+start_x));
+public:
+    StarFitsJob(usImage *img, const wxString& fileName, int startX, int startY)
+        : ImageWriteJob(img, fileName), m_startX(startX), m_startY(startY) { }
 
-    wxString fname = Debug.GetLogDir() + PATHSEPSTR + "PHD_GuideStar" + wxDateTime::Now().Format(_T("_%j_%H%M%S")) + ".fit";
+    bool Write(const wxString& path);
+};
 
+bool StarFitsJob::Write(const wxString& path)
+{
     fitsfile *fptr;  // FITS file pointer
     int status = 0;  // CFITSIO status value MUST be initialized to zero!
     long fpixel[3] = {1,1,1};
@@ -833,10 +1134,10 @@ void GuiderOneStar::SaveStarFITS()
     char keystring[100];
     int output_format=USHORT_IMG;
 
-    fsize[0] = 60;
-    fsize[1] = 60;
+    fsize[0] = m_img->Size.GetWidth();
+    fsize[1] = m_img->Size.GetHeight();
     fsize[2] = 0;
-    PHD_fits_create_file(&fptr, fname, false, &status);
+    PHD_fits_create_file(&fptr, path, true, &status);
     if (!status)
     {
         fits_create_img(fptr,output_format, 2, fsize, &status);
@@ -852,12 +1153,12 @@ void GuiderOneStar::SaveStarFITS()
 
         sprintf(keyname,"DATE-OBS");
         sprintf(keycomment,"YYYY-MM-DDThh:mm:ss observation start, UT");
-        sprintf(keystring,"%s", (const char *) pImage->GetImgStartTime().c_str());
+        sprintf(keystring,"%s", (const char *) m_img->GetImgStartTime().c_str());
         if (!status) fits_write_key(fptr, TSTRING, keyname, keystring, keycomment, &status);
 
         sprintf(keyname,"EXPOSURE");
         sprintf(keycomment,"Exposure time [s]");
-        float dur = (float) pImage->ImgExpDur / 1000.0;
+        float dur = (float) m_img->ImgExpDur / 1000.0;
         if (!status) fits_write_key(fptr, TFLOAT, keyname, &dur, keycomment, &status);
 
         unsigned int tmp = 1;
@@ -870,17 +1171,53 @@ void GuiderOneStar::SaveStarFITS()
 
         sprintf(keyname,"XORGSUB");
         sprintf(keycomment,"Subframe x position in binned pixels");
-        tmp = start_x;
+        tmp = m_startX;
         fits_write_key(fptr, TINT, keyname, &tmp, keycomment, &status);
         sprintf(keyname,"YORGSUB");
         sprintf(keycomment,"Subframe y position in binned pixels");
-        tmp = start_y;
+        tmp = m_startY;
         fits_write_key(fptr, TINT, keyname, &tmp, keycomment, &status);
 
-        if (!status) fits_write_pix(fptr,TUSHORT,fpixel,tmpimg.NPixels,tmpimg.ImageData,&status);
+        if (!status) fits_write_pix(fptr,TUSHORT,fpixel,m_img->NPixels,m_img->ImageData,&status);
 
     }
     PHD_fits_close_file(fptr);
+
+    return status != 0;
+}
+
+void GuiderOneStar::SaveStarFITS()
+{
+    double StarX = m_star.X;
+    double StarY = m_star.Y;
+    usImage *pImage = CurrentImage();
+    usImage *tmpimg = ImgWriter.GetImage();
+
+    if (tmpimg->Init(60,60))
+    {
+        ImgWriter.ReleaseImage(tmpimg);
+        return;
+    }
+    tmpimg->ImgStartTime = pImage->ImgStartTime;
+    tmpimg->ImgExpDur = pImage->ImgExpDur;
+
+    int start_x = ROUND(StarX)-30;
+    int start_y = ROUND(StarY)-30;
+    if ((start_x + 60) > pImage->Size.GetWidth())
+        start_x = pImage->Size.GetWidth() - 60;
+    if ((start_y + 60) > pImage->Size.GetHeight())
+        start_y = pImage->Size.GetHeight() - 60;
+    int x,y, width;
+    width = pImage->Size.GetWidth();
+    unsigned short *usptr = tmpimg->ImageData;
+    for (y=0; y<60; y++)
+        for (x=0; x<60; x++, usptr++)
+            *usptr = *(pImage->ImageData + (y+start_y)*width + (x+start_x));
+
+    wxString fname = Debug.GetLogDir() + PATHSEPSTR + "PHD_GuideStar" + wxDateTime::Now().Format(_T("_%j_%H%M%S")) + ".fit";
+
+    // written on the ImageWriter thread so image logging does not hold up guiding
+    ImgWriter.Queue(new StarFitsJob(tmpimg, fname, start_x, start_y));
 }
 
 wxString GuiderOneStar::GetSettingsSummary()
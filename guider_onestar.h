@@ -41,12 +41,21 @@
 #define GUIDER_ONESTAR_H_INCLUDED
 
 class MassChecker;
+class StarMotionPredictor;
 
 class GuiderOneStar : public Guider
 {
 private:
     Star m_star;
     MassChecker *m_massChecker;
+    StarMotionPredictor *m_predictor;
+    StarCatalog *m_catalog;
+
+    // adaptive subframe sizing
+    double m_starExcursion;     // recent maximum distance of the star from the lock position
+    int m_roiHalfWidth;
+    int m_roiShrinkFrames;
+    wxSize m_lastRoiSize;
 
     // parameters
     bool m_massChangeThresholdEnabled;
@@ -100,12 +109,17 @@ public:
 
     virtual void LoadProfileSettings(void);
 
-private:
+protected:
     virtual bool IsValidLockPosition(const PHD_Point& pt);
     virtual void InvalidateCurrentPosition(bool fullReset = false);
     virtual bool UpdateCurrentPosition(usImage *pImage, FrameDroppedInfo *errorInfo);
     virtual bool SetCurrentPosition(usImage *pImage, const PHD_Point& position);
 
+private:
+    void ResetRoi(void);
+    bool ReacquireStar(const usImage *pImage, Star *newStar);
+    int AdaptiveRoiHalfWidth(void);
+
     void OnLClick(wxMouseEvent& evt);
 
     void SaveStarFITS();
@@ -180,6 +180,28 @@ struct GuidingAsstWin : public wxDialog
     double m_lastTime;
     double maxRateRA; // arc-sec per second
 
+    // latest results, from the thread running the guide step, for DisplayInfo
+    struct DisplayValues
+    {
+        double exposure;
+        double snr;
+        double mass;
+        wxLongLong_t elapsedms;
+        double n;
+        double pxscale;
+        double rarms;
+        double decrms;
+        double combined;
+        double raPeak;
+        double decPeak;
+        double rangeRA;
+        double raDriftRate;
+        double decDriftRate;
+        double maxRateRA;
+    };
+    wxCriticalSection m_displayLock;
+    DisplayValues m_display;
+
     bool m_savePrimaryMountEnabled;
     bool m_saveSecondaryMountEnabled;
     bool m_measurementsTaken;
@@ -199,6 +221,7 @@ struct GuidingAsstWin : public wxDialog
     wxStaticText* AddRecommendationEntry(const wxString& msg, wxObjectEventFunction handler, wxButton** ppButton);
     wxStaticText* AddRecommendationEntry(const wxString& msg);
     void UpdateInfo(const GuideStepInfo& info);
+    void DisplayInfo(void);
     void FillInstructions(DialogState eState);
     void MakeRecommendations();
 };
@@ -733,8 +756,8 @@ void GuidingAsstWin::OnClose(wxCloseEvent& evt)
 
 void GuidingAsstWin::UpdateInfo(const GuideStepInfo& info)
 {
-    double ra = info.mountOffset->X;
-    double dec = info.mountOffset->Y;
+    double ra = info.mountOffset.X;
+    double dec = info.mountOffset.Y;
     double prevRAlpf = m_statsRA.lpf;
 
     m_statsRA.AddSample(ra);
@@ -743,7 +766,7 @@ void GuidingAsstWin::UpdateInfo(const GuideStepInfo& info)
     if (m_statsRA.n == 1)
     {
         minRA = maxRA = ra;
-        m_startPos = *info.mountOffset;
+        m_startPos = info.mountOffset;
         maxRateRA = 0.0;
     }
     else
@@ -785,36 +808,65 @@ void GuidingAsstWin::UpdateInfo(const GuideStepInfo& info)
     double raDriftRate = driftRA / elapsed * 60.0;
     double decDriftRate = driftDec / elapsed * 60.0;
 
+    // the grids are filled in by DisplayInfo when the display is refreshed
+    {
+        wxCriticalSectionLocker lock(m_displayLock);
+        m_display.exposure = (double) pFrame->RequestedExposureDuration() / 1000.0;
+        m_display.snr = sumSNR / n;
+        m_display.mass = sumMass / n;
+        m_display.elapsedms = elapsedms;
+        m_display.n = n;
+        m_display.pxscale = pxscale;
+        m_display.rarms = rarms;
+        m_display.decrms = decrms;
+        m_display.combined = combined;
+        m_display.raPeak = m_statsRA.peakRawDx;
+        m_display.decPeak = m_statsDec.peakRawDx;
+        m_display.rangeRA = rangeRA;
+        m_display.raDriftRate = raDriftRate;
+        m_display.decDriftRate = decDriftRate;
+        m_display.maxRateRA = maxRateRA;
+    }
 
+    pFrame->m_uiRefresh.Request(UI_REFRESH_ASSISTANT);
+}
+
+void GuidingAsstWin::DisplayInfo(void)
+{
+    DisplayValues d;
+    {
+        wxCriticalSectionLocker lock(m_displayLock);
+        d = m_display;
+    }
 
     m_statusgrid->SetCellValue(m_timestamp_loc, startStr);
-    m_statusgrid->SetCellValue(m_exposuretime_loc, wxString::Format("%gs", (double)pFrame->RequestedExposureDuration() / 1000.0));
-    m_statusgrid->SetCellValue(m_snr_loc, wxString::Format("%.1f", sumSNR / n));
-    m_statusgrid->SetCellValue(m_starmass_loc, wxString::Format("%.1f", sumMass / n));
-    m_statusgrid->SetCellValue(m_elapsedtime_loc, wxString::Format("%us", (unsigned int)(elapsedms / 1000)));
-    m_statusgrid->SetCellValue(m_samplecount_loc, wxString::Format("%.0f", n));
+    m_statusgrid->SetCellValue(m_exposuretime_loc, wxString::Format("%gs", d.exposure));
+    m_statusgrid->SetCellValue(m_snr_loc, wxString::Format("%.1f", d.snr));
+    m_statusgrid->SetCellValue(m_starmass_loc, wxString::Format("%.1f", d.mass));
+    m_statusgrid->SetCellValue(m_elapsedtime_loc, wxString::Format("%us", (unsigned int)(d.elapsedms / 1000)));
+    m_statusgrid->SetCellValue(m_samplecount_loc, wxString::Format("%.0f", d.n));
     //m_statusgrid->SetCellValue(m_hfcutoff_loc, wxString::Format("%.2f Hz", m_freqThresh));
 
-    m_displacementgrid->SetCellValue(m_ra_rms_px_loc, wxString::Format("%6.2f px", rarms));
-    m_displacementgrid->SetCellValue(m_ra_rms_as_loc, wxString::Format("%6.2f arc-sec", rarms * pxscale));
-    m_displacementgrid->SetCellValue(m_dec_rms_px_loc, wxString::Format("%6.2f px", decrms));
-    m_displacementgrid->SetCellValue(m_dec_rms_as_loc, wxString::Format("%6.2f arc-sec", decrms * pxscale));
-    m_displacementgrid->SetCellValue(m_total_rms_px_loc, wxString::Format("%6.2f px", combined));
-    m_displacementgrid->SetCellValue(m_total_rms_as_loc, wxString::Format("%6.2f arc-sec", combined * pxscale));
-
-    m_othergrid->SetCellValue(m_ra_peak_px_loc, wxString::Format("% .1f px", m_statsRA.peakRawDx));
-    m_othergrid->SetCellValue(m_ra_peak_as_loc, wxString::Format("% .1f arc-sec", m_statsRA.peakRawDx * pxscale));
-    m_othergrid->SetCellValue(m_dec_peak_px_loc, wxString::Format("% .1f px", m_statsDec.peakRawDx));
-    m_othergrid->SetCellValue(m_dec_peak_as_loc, wxString::Format("% .1f arc-sec", m_statsRA.peakRawDx * pxscale));
-    m_othergrid->SetCellValue(m_ra_peakpeak_px_loc, wxString::Format("% .1f px", rangeRA));
-    m_othergrid->SetCellValue(m_ra_peakpeak_as_loc, wxString::Format("% .1f arc-sec", rangeRA * pxscale));
-    m_othergrid->SetCellValue(m_ra_drift_px_loc, wxString::Format("% .1f px/min", raDriftRate));
-    m_othergrid->SetCellValue(m_ra_drift_as_loc, wxString::Format("% .1f arc-sec/min", raDriftRate * pxscale));
-    m_othergrid->SetCellValue(m_ra_peak_drift_px_loc, wxString::Format("% .1f px/sec", maxRateRA));
+    m_displacementgrid->SetCellValue(m_ra_rms_px_loc, wxString::Format("%6.2f px", d.rarms));
+    m_displacementgrid->SetCellValue(m_ra_rms_as_loc, wxString::Format("%6.2f arc-sec", d.rarms * d.pxscale));
+    m_displacementgrid->SetCellValue(m_dec_rms_px_loc, wxString::Format("%6.2f px", d.decrms));
+    m_displacementgrid->SetCellValue(m_dec_rms_as_loc, wxString::Format("%6.2f arc-sec", d.decrms * d.pxscale));
+    m_displacementgrid->SetCellValue(m_total_rms_px_loc, wxString::Format("%6.2f px", d.combined));
+    m_displacementgrid->SetCellValue(m_total_rms_as_loc, wxString::Format("%6.2f arc-sec", d.combined * d.pxscale));
+
+    m_othergrid->SetCellValue(m_ra_peak_px_loc, wxString::Format("% .1f px", d.raPeak));
+    m_othergrid->SetCellValue(m_ra_peak_as_loc, wxString::Format("% .1f arc-sec", d.raPeak * d.pxscale));
+    m_othergrid->SetCellValue(m_dec_peak_px_loc, wxString::Format("% .1f px", d.decPeak));
+    m_othergrid->SetCellValue(m_dec_peak_as_loc, wxString::Format("% .1f arc-sec", d.decPeak * d.pxscale));
+    m_othergrid->SetCellValue(m_ra_peakpeak_px_loc, wxString::Format("% .1f px", d.rangeRA));
+    m_othergrid->SetCellValue(m_ra_peakpeak_as_loc, wxString::Format("% .1f arc-sec", d.rangeRA * d.pxscale));
+    m_othergrid->SetCellValue(m_ra_drift_px_loc, wxString::Format("% .1f px/min", d.raDriftRate));
+    m_othergrid->SetCellValue(m_ra_drift_as_loc, wxString::Format("% .1f arc-sec/min", d.raDriftRate * d.pxscale));
+    m_othergrid->SetCellValue(m_ra_peak_drift_px_loc, wxString::Format("% .1f px/sec", d.maxRateRA));
     m_othergrid->SetCellValue(m_ra_peak_drift_as_loc, wxString::Format("% .1f arc-sec/sec (Max Exp: %.1fs)",
-        maxRateRA * pxscale, maxRateRA > 0.0 ? rarms / maxRateRA : 0.0));
-    m_othergrid->SetCellValue(m_dec_drift_px_loc, wxString::Format("% .1f px/min", decDriftRate));
-    m_othergrid->SetCellValue(m_dec_drift_as_loc, wxString::Format("% .1f arc-sec/min", decDriftRate * pxscale));
+        d.maxRateRA * d.pxscale, d.maxRateRA > 0.0 ? d.rarms / d.maxRateRA : 0.0));
+    m_othergrid->SetCellValue(m_dec_drift_px_loc, wxString::Format("% .1f px/min", d.decDriftRate));
+    m_othergrid->SetCellValue(m_dec_drift_as_loc, wxString::Format("% .1f arc-sec/min", d.decDriftRate * d.pxscale));
 }
 
 wxWindow *GuidingAssistant::CreateDialogBox()
@@ -832,6 +884,16 @@ void GuidingAssistant::NotifyGuideStep(const GuideStepInfo& info)
     }
 }
 
+void GuidingAssistant::UpdateDisplay(void)
+{
+    if (pFrame && pFrame->pGuidingAssistant)
+    {
+        GuidingAsstWin *win = static_cast<GuidingAsstWin *>(pFrame->pGuidingAssistant);
+        if (win->m_measuring)
+            win->DisplayInfo();
+    }
+}
+
 void GuidingAssistant::NotifyFrameDropped(const FrameDroppedInfo& info)
 {
     if (pFrame && pFrame->pGuidingAssistant)
@@ -41,6 +41,7 @@ class GuidingAssistant
 public:
     static wxWindow *CreateDialogBox();
     static void NotifyGuideStep(const GuideStepInfo& info);
+    static void UpdateDisplay(void);
     static void NotifyFrameDropped(const FrameDroppedInfo& info);
     static void UpdateUIControls();
 };
@@ -393,8 +393,8 @@ void GuidingLog::GuideStep(const GuideStepInfo& step)
     m_file.Write(wxString::Format("%d,%.3f,\"%s\",%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,",
         step.frameNumber, step.time,
         step.mount->IsStepGuider() ? "AO" : "Mount",
-        step.cameraOffset->X, step.cameraOffset->Y,
-        step.mountOffset->X, step.mountOffset->Y,
+        step.cameraOffset.X, step.cameraOffset.Y,
+        step.mountOffset.X, step.mountOffset.Y,
         step.guideDistanceRA, step.guideDistanceDec));
 
     if (step.mount->IsStepGuider())
@@ -429,6 +429,15 @@ void GuidingLog::FrameDropped(const FrameDroppedInfo& info)
     Flush();
 }
 
+void GuidingLog::NotifyStaleFrameDropped(double ageMs, unsigned int totalDropped)
+{
+    if (!m_enabled || !m_isGuiding)
+        return;
+
+    m_file.Write(wxString::Format("INFO: STALE FRAME DROPPED, age = %.0f ms, total dropped = %u\n", ageMs, totalDropped));
+    Flush();
+}
+
 void GuidingLog::NotifyGuidingDithered(Guider *guider, double dx, double dy)
 {
     if (!m_enabled || !m_isGuiding)
@@ -445,6 +454,15 @@ void GuidingLog::NotifySettlingStateChange(const wxString& msg)
     Flush();
 }
 
+void GuidingLog::NotifyGuideROI(const wxRect& roi)
+{
+    if (!m_enabled || !m_isGuiding)
+        return;
+
+    m_file.Write(wxString::Format("INFO: ROI size = %dx%d\n", roi.GetWidth(), roi.GetHeight()));
+    Flush();
+}
+
 void GuidingLog::NotifySetLockPosition(Guider *guider)
 {
     if (!m_enabled || !m_isGuiding)
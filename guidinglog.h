@@ -42,13 +42,16 @@ class Mount;
 class Guider;
 struct LockPosShiftParams;
 
+// A guide step, passed by value from the thread that moved the mount to the
+// consumers on the main thread (see GuideStepBus)
 struct GuideStepInfo
 {
     Mount *mount;
+    bool normalMove;
     int frameNumber;
     double time;
-    const PHD_Point *cameraOffset;
-    const PHD_Point *mountOffset;
+    PHD_Point cameraOffset;
+    PHD_Point mountOffset;
     double guideDistanceRA;
     double guideDistanceDec;
     int durationRA;
@@ -109,12 +112,14 @@ public:
     void StopGuiding();
     void GuideStep(const GuideStepInfo& info);
     void FrameDropped(const FrameDroppedInfo& info);
+    void NotifyStaleFrameDropped(double ageMs, unsigned int totalDropped);
 
     void ServerCommand(Guider *guider, const wxString& cmd);
     void NotifyGuidingDithered(Guider *guider, double dx, double dy);
     void NotifySetLockPosition(Guider *guider);
     void NotifyLockShiftParams(const LockPosShiftParams& shiftParams, const PHD_Point& cameraRate);
     void NotifySettlingStateChange(const wxString& msg);
+    void NotifyGuideROI(const wxRect& roi);
 
     void SetGuidingParam(const wxString& name, double val);
     void SetGuidingParam(const wxString& name, int val);
@@ -316,7 +316,8 @@ inline static unsigned short median3(const unsigned short l[3])
     return l0;
 }
 
-bool Median3(unsigned short *dst, const unsigned short *src, const wxSize& size, const wxRect& rect)
+// median-filter a single row y of the rectangle rect, writing RW pixels to d
+static void Median3Row(unsigned short *d, const unsigned short *src, const wxSize& size, const wxRect& rect, int y)
 {
     int const W = size.GetWidth();
     int const RX = rect.GetX();
@@ -325,43 +326,71 @@ bool Median3(unsigned short *dst, const unsigned short *src, const wxSize& size,
     int const RH = rect.GetHeight();
 
     unsigned short a[9];
-    unsigned short *d;
 
 #define IX(x_, y_) ((RY + (y_)) * W + RX + (x_))
 
-    // top row
-    d = &dst[IX(0, 0)];
+    if (y == 0)
+    {
+        // top row
 
-    // top-left corner
-    a[0] = src[IX(0, 0)];
-    a[1] = src[IX(1, 0)];
-    a[2] = src[IX(0, 1)];
-    a[3] = src[IX(1, 1)];
-    *d++ = median4(a);
+        // top-left corner
+        a[0] = src[IX(0, 0)];
+        a[1] = src[IX(1, 0)];
+        a[2] = src[IX(0, 1)];
+        a[3] = src[IX(1, 1)];
+        *d++ = median4(a);
 
-    // top row middle pixels
-    for (int x = 1; x <= RW - 2; x++)
-    {
-        a[0] = src[IX(x - 1, 0)];
-        a[1] = src[IX(x,     0)];
-        a[2] = src[IX(x + 1, 0)];
-        a[3] = src[IX(x - 1, 1)];
-        a[4] = src[IX(x,     1)];
-        a[5] = src[IX(x + 1, 1)];
-        *d++ = median6(a);
+        // top row middle pixels
+        for (int x = 1; x <= RW - 2; x++)
+        {
+            a[0] = src[IX(x - 1, 0)];
+            a[1] = src[IX(x,     0)];
+            a[2] = src[IX(x + 1, 0)];
+            a[3] = src[IX(x - 1, 1)];
+            a[4] = src[IX(x,     1)];
+            a[5] = src[IX(x + 1, 1)];
+            *d++ = median6(a);
+        }
+
+        // top-right corner
+        a[0] = src[IX(RW - 2, 0)];
+        a[1] = src[IX(RW - 1, 0)];
+        a[2] = src[IX(RW - 2, 1)];
+        a[3] = src[IX(RW - 1, 1)];
+        *d = median4(a);
     }
+    else if (y == RH - 1)
+    {
+        // bottom row
 
-    // top-right corner
-    a[0] = src[IX(RW - 2, 0)];
-    a[1] = src[IX(RW - 1, 0)];
-    a[2] = src[IX(RW - 2, 1)];
-    a[3] = src[IX(RW - 1, 1)];
-    *d = median4(a);
+        // bottom-left corner
+        a[0] = src[IX(0, RH - 2)];
+        a[1] = src[IX(1, RH - 2)];
+        a[2] = src[IX(0, RH - 1)];
+        a[3] = src[IX(1, RH - 1)];
+        *d++ = median4(a);
 
-    for (int y = 1; y <= RH - 2; y++)
-    {
-        d = &dst[IX(0, y)];
+        // bottom row middle pixels
+        for (int x = 1; x <= RW - 2; x++)
+        {
+            a[0] = src[IX(x - 1, RH - 2)];
+            a[1] = src[IX(x    , RH - 2)];
+            a[2] = src[IX(x + 1, RH - 2)];
+            a[3] = src[IX(x - 1, RH - 1)];
+            a[4] = src[IX(x    , RH - 1)];
+            a[5] = src[IX(x + 1, RH - 1)];
+            *d++ = median6(a);
+        }
 
+        // bottom-right corner
+        a[0] = src[IX(RW - 2, RH - 2)];
+        a[1] = src[IX(RW - 1, RH - 2)];
+        a[2] = src[IX(RW - 2, RH - 1)];
+        a[3] = src[IX(RW - 1, RH - 1)];
+        *d = median4(a);
+    }
+    else
+    {
         // leftmost pixel
         a[0] = src[IX(0, y - 1)];
         a[1] = src[IX(1, y - 1)];
@@ -392,41 +421,32 @@ bool Median3(unsigned short *dst, const unsigned short *src, const wxSize& size,
         a[3] = src[IX(RW - 1, y    )];
         a[4] = src[IX(RW - 2, y + 1)];
         a[5] = src[IX(RW - 1, y + 1)];
-        *d++ = median6(a);
+        *d = median6(a);
     }
 
-    // bottom row
-    d = &dst[IX(0, RH - 1)];
+#undef IX
+}
 
-    // bottom-left corner
-    a[0] = src[IX(0, RH - 2)];
-    a[1] = src[IX(1, RH - 2)];
-    a[2] = src[IX(0, RH - 1)];
-    a[3] = src[IX(1, RH - 1)];
-    *d++ = median4(a);
+bool Median3(unsigned short *dst, const unsigned short *src, const wxSize& size, const wxRect& rect)
+{
+    int const W = size.GetWidth();
 
-    // bottom row middle pixels
-    for (int x = 1; x <= RW - 2; x++)
-    {
-        a[0] = src[IX(x - 1, RH - 2)];
-        a[1] = src[IX(x    , RH - 2)];
-        a[2] = src[IX(x + 1, RH - 2)];
-        a[3] = src[IX(x - 1, RH - 1)];
-        a[4] = src[IX(x    , RH - 1)];
-        a[5] = src[IX(x + 1, RH - 1)];
-        *d++ = median6(a);
-    }
+    for (int y = 0; y < rect.GetHeight(); y++)
+        Median3Row(&dst[(rect.GetY() + y) * W + rect.GetX()], src, size, rect, y);
 
-    // bottom-right corner
-    a[0] = src[IX(RW - 2, RH - 2)];
-    a[1] = src[IX(RW - 1, RH - 2)];
-    a[2] = src[IX(RW - 2, RH - 1)];
-    a[3] = src[IX(RW - 1, RH - 1)];
-    *d = median4(a);
+    return false;
+}
 
-#undef IX
+void Median3Rows(unsigned short *dst, const unsigned short *src, const wxSize& size, int firstRow, int numRows)
+{
+    // filter rows [firstRow, firstRow + numRows) of the full frame into dst,
+    // which receives numRows rows of size.GetWidth() pixels. The output is
+    // identical to the corresponding rows of a full-frame Median3
+    wxRect rect(size);
+    int const W = size.GetWidth();
 
-    return false;
+    for (int i = 0; i < numRows; i++)
+        Median3Row(&dst[i * W], src, size, rect, firstRow + i);
 }
 
 static unsigned short MedianBorderingPixels(const usImage& img, int x, int y)
@@ -0,0 +1,266 @@
+/*
+ *  image_writer.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2016 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "phd.h"
+
+static const bool DefaultCompress = false;
+
+ImageWriter ImgWriter;
+
+ImageWriteJob::ImageWriteJob(usImage *img, const wxString& fileName)
+    : m_img(img),
+      m_fileName(fileName)
+{
+}
+
+ImageWriteJob::~ImageWriteJob(void)
+{
+    if (m_img)
+        ImgWriter.ReleaseImage(m_img);
+}
+
+// a frame saved with usImage::Save
+class SaveImageJob : public ImageWriteJob
+{
+    wxString m_hdrNote;
+    bool m_compress;
+
+public:
+    SaveImageJob(usImage *img, const wxString& fileName, const wxString& hdrNote, bool compress)
+        : ImageWriteJob(img, fileName), m_hdrNote(hdrNote), m_compress(compress) { }
+
+    bool Write(const wxString& path)
+    {
+        if (m_img->Save(path, m_hdrNote, m_compress))
+        {
+            pFrame->Alert(wxString::Format(_("The image could not be saved to %s"), m_fileName));
+            return true;
+        }
+        return false;
+    }
+};
+
+class ImageWriter::Thread : public wxThread
+{
+    ImageWriter *m_writer;
+
+public:
+    Thread(ImageWriter *writer)
+        : wxThread(wxTHREAD_JOINABLE), m_writer(writer) { }
+
+    ExitCode Entry(void)
+    {
+        m_writer->WriteFiles();
+        return 0;
+    }
+};
+
+ImageWriter::ImageWriter(void)
+    : m_wakeup(m_lock),
+      m_thread(0),
+      m_stop(false),
+      m_compress(DefaultCompress)
+{
+}
+
+ImageWriter::~ImageWriter(void)
+{
+    // Stop has written anything that was queued; this only runs at exit
+    for (std::deque<ImageWriteJob *>::iterator it = m_jobs.begin(); it != m_jobs.end(); ++it)
+        delete *it;
+    m_jobs.clear();
+
+    for (std::vector<usImage *>::iterator it = m_pool.begin(); it != m_pool.end(); ++it)
+        delete *it;
+}
+
+void ImageWriter::LoadProfileSettings(void)
+{
+    SetCompress(pConfig->Profile.GetBoolean("/ImageWriter/Compress", DefaultCompress));
+}
+
+void ImageWriter::SetCompress(bool compress)
+{
+    m_compress = compress;
+    pConfig->Profile.SetBoolean("/ImageWriter/Compress", m_compress);
+}
+
+usImage *ImageWriter::GetImage(void)
+{
+    wxMutexLocker lock(m_lock);
+
+    if (m_pool.empty())
+        return new usImage();
+
+    usImage *img = m_pool.back();
+    m_pool.pop_back();
+    return img;
+}
+
+void ImageWriter::ReleaseImage(usImage *img)
+{
+    {
+        wxMutexLocker lock(m_lock);
+        if (m_pool.size() < POOL_SIZE)
+        {
+            m_pool.push_back(img);
+            return;
+        }
+    }
+
+    delete img;
+}
+
+void ImageWriter::WriteFiles(void)
+{
+    wxMutexLocker lock(m_lock);
+
+    while (true)
+    {
+        while (m_jobs.empty() && !m_stop)
+            m_wakeup.Wait();
+
+        // when stopping, finish what was queued first
+        if (m_jobs.empty())
+            break;
+
+        ImageWriteJob *job = m_jobs.front();
+        m_jobs.pop_front();
+
+        m_lock.Unlock();
+
+        // write under a temporary name so nobody reads a partial file
+        wxString path = job->m_fileName + _T(".part");
+        bool err = job->Write(path);
+        if (!err && !wxRenameFile(path, job->m_fileName, true))
+            err = true;
+        if (err)
+        {
+            Debug.AddLine("ImageWriter: could not write " + job->m_fileName);
+            if (wxFileExists(path))
+                wxRemoveFile(path);
+        }
+
+        delete job;
+
+        m_lock.Lock();
+    }
+}
+
+bool ImageWriter::Queue(ImageWriteJob *job)
+{
+    bool bError = false;
+
+    {
+        wxMutexLocker lock(m_lock);
+
+        try
+        {
+            if (m_stop)
+            {
+                throw ERROR_INFO("ImageWriter: stopped");
+            }
+
+            if (m_jobs.size() >= MAX_PENDING)
+            {
+                throw ERROR_INFO("ImageWriter: too many files waiting to be written");
+            }
+
+            if (!m_thread)
+            {
+                Thread *thread = new Thread(this);
+
+                if (thread->Create() != wxTHREAD_NO_ERROR || thread->Run() != wxTHREAD_NO_ERROR)
+                {
+                    delete thread;
+                    throw ERROR_INFO("ImageWriter: could not start thread");
+                }
+
+                m_thread = thread;
+            }
+
+            m_jobs.push_back(job);
+            m_wakeup.Signal();
+        }
+        catch (wxString Msg)
+        {
+            POSSIBLY_UNUSED(Msg);
+            bError = true;
+        }
+    }
+
+    if (bError)
+    {
+        Debug.AddLine("ImageWriter: dropped " + job->m_fileName);
+        delete job;
+    }
+
+    return bError;
+}
+
+bool ImageWriter::Save(const usImage& img, const wxString& fileName, const wxString& hdrNote)
+{
+    usImage *copy = GetImage();
+
+    if (copy->CopyFrom(img))
+    {
+        ReleaseImage(copy);
+        return true;
+    }
+
+    copy->Subframe = img.Subframe;
+    copy->ImgStartTime = img.ImgStartTime;
+    copy->ImgExpDur = img.ImgExpDur;
+    copy->ImgStackCnt = img.ImgStackCnt;
+
+    return Queue(new SaveImageJob(copy, fileName, hdrNote, m_compress));
+}
+
+void ImageWriter::Stop(void)
+{
+    Thread *thread;
+
+    {
+        wxMutexLocker lock(m_lock);
+        m_stop = true;
+        m_wakeup.Signal();
+        thread = m_thread;
+        m_thread = 0;
+    }
+
+    if (thread)
+    {
+        thread->Wait();
+        delete thread;
+    }
+}
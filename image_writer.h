@@ -0,0 +1,107 @@
+/*
+ *  image_writer.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2016 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef IMAGE_WRITER_H_INCLUDED
+#define IMAGE_WRITER_H_INCLUDED
+
+// A FITS file waiting to be written. The image, if the job has one, comes
+// from ImageWriter::GetImage and goes back to the writer's pool when the job
+// is deleted.
+class ImageWriteJob
+{
+protected:
+    usImage *m_img;
+
+public:
+    wxString m_fileName;
+
+    ImageWriteJob(usImage *img, const wxString& fileName);
+    virtual ~ImageWriteJob(void);
+
+    // write the file to path; returns true on error
+    virtual bool Write(const wxString& path) = 0;
+};
+
+// Writes FITS files on a background thread so saving an image never blocks
+// guiding. Callers snapshot the frame into a pooled buffer and queue a job;
+// the file appears under its final name only once it is complete.
+class ImageWriter
+{
+    class Thread;
+
+    enum
+    {
+        MAX_PENDING = 16,       // jobs beyond this are dropped
+        POOL_SIZE = 4,          // spare image buffers kept for reuse
+    };
+
+    wxMutex m_lock;
+    wxCondition m_wakeup;
+    Thread *m_thread;
+    bool m_stop;
+    std::deque<ImageWriteJob *> m_jobs;
+    std::vector<usImage *> m_pool;
+    bool m_compress;
+
+    void WriteFiles(void);
+
+public:
+    ImageWriter(void);
+    ~ImageWriter(void);
+
+    void LoadProfileSettings(void);
+    bool GetCompress(void) const;
+    void SetCompress(bool compress);
+
+    // buffer for a job's image, from the pool if one is free; any thread
+    usImage *GetImage(void);
+    void ReleaseImage(usImage *img);
+
+    // takes ownership of the job; returns true if it could not be queued
+    bool Queue(ImageWriteJob *job);
+
+    // copy img and queue it to be saved like usImage::Save
+    bool Save(const usImage& img, const wxString& fileName, const wxString& hdrNote = wxEmptyString);
+
+    // write the pending files and stop the thread; main thread only
+    void Stop(void);
+};
+
+extern ImageWriter ImgWriter;
+
+inline bool ImageWriter::GetCompress(void) const
+{
+    return m_compress;
+}
+
+#endif /* IMAGE_WRITER_H_INCLUDED */
@@ -0,0 +1,207 @@
+/*
+ *  latency_stats.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2016 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "phd.h"
+
+#include <algorithm>
+
+#if defined(__WINDOWS__)
+# include <wx/msw/wrapwin.h>
+#elif defined(__APPLE__)
+# include <mach/mach_time.h>
+#else
+# include <time.h>
+#endif
+
+LatencyStats::LatencyStats(void)
+    : m_count(0),
+      m_next(0),
+      m_total(0)
+{
+}
+
+void LatencyStats::Add(double ms)
+{
+    wxCriticalSectionLocker lock(m_lock);
+
+    m_samples[m_next] = ms;
+    m_next = (m_next + 1) % MAX_SAMPLES;
+    if (m_count < MAX_SAMPLES)
+        ++m_count;
+    ++m_total;
+}
+
+void LatencyStats::Reset(void)
+{
+    wxCriticalSectionLocker lock(m_lock);
+
+    m_count = 0;
+    m_next = 0;
+    m_total = 0;
+}
+
+inline static double Percentile(const std::vector<double>& sorted, double p)
+{
+    // nearest rank
+    size_t rank = (size_t) ceil(p * sorted.size());
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+unsigned int LatencyStats::GetPercentiles(double *p50, double *p95, double *p99) const
+{
+    std::vector<double> sorted;
+
+    {
+        wxCriticalSectionLocker lock(m_lock);
+        sorted.assign(m_samples, m_samples + m_count);
+    }
+
+    if (sorted.empty())
+    {
+        *p50 = *p95 = *p99 = 0.0;
+        return 0;
+    }
+
+    std::sort(sorted.begin(), sorted.end());
+
+    *p50 = Percentile(sorted, 0.50);
+    *p95 = Percentile(sorted, 0.95);
+    *p99 = Percentile(sorted, 0.99);
+
+    return sorted.size();
+}
+
+unsigned int LatencyStats::TotalSamples(void) const
+{
+    wxCriticalSectionLocker lock(m_lock);
+    return m_total;
+}
+
+// The system's monotonic clock, so intervals are not affected when the time
+// of day is set or stepped by NTP. wxStopWatch cannot be used: on Unix it
+// reads the time of day.
+wxLongLong_t LatencyStats::Now(void)
+{
+#if defined(__WINDOWS__)
+    static LARGE_INTEGER s_freq;
+    if (!s_freq.QuadPart)
+        ::QueryPerformanceFrequency(&s_freq);
+    LARGE_INTEGER t;
+    ::QueryPerformanceCounter(&t);
+    return (wxLongLong_t) (t.QuadPart / s_freq.QuadPart) * 1000000 +
+        (wxLongLong_t) (t.QuadPart % s_freq.QuadPart) * 1000000 / s_freq.QuadPart;
+#elif defined(__APPLE__)
+    static mach_timebase_info_data_t s_timebase;
+    if (!s_timebase.denom)
+        mach_timebase_info(&s_timebase);
+    return (wxLongLong_t) (mach_absolute_time() * s_timebase.numer / s_timebase.denom / 1000);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (wxLongLong_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+GuideCycleStats::GuideCycleStats(void)
+    : m_exposureEnd(0),
+      m_analyzed(0)
+{
+}
+
+void GuideCycleStats::AddSample(GuideCycleStage stage, wxLongLong_t durationUs)
+{
+    m_stages[stage].Add((double) durationUs / 1000.0);
+}
+
+void GuideCycleStats::FrameAnalyzed(const usImage& img)
+{
+    wxCriticalSectionLocker lock(m_lock);
+
+    m_exposureEnd = img.ImgExposureEndUs;
+    m_analyzed = LatencyStats::Now();
+}
+
+void GuideCycleStats::PulsesComplete(wxLongLong_t pulseStart, wxLongLong_t pulseEnd)
+{
+    AddSample(STAGE_PULSE, pulseEnd - pulseStart);
+
+    wxCriticalSectionLocker lock(m_lock);
+
+    // a frame can produce moves on both mounts; the first one completes the cycle
+    if (m_exposureEnd)
+    {
+        AddSample(STAGE_PULSE_ISSUE, pulseStart - m_analyzed);
+        AddSample(STAGE_TOTAL, pulseEnd - m_exposureEnd);
+        m_exposureEnd = 0;
+    }
+}
+
+void GuideCycleStats::Reset(void)
+{
+    for (int i = 0; i < STAGE_COUNT; i++)
+        m_stages[i].Reset();
+}
+
+const char *GuideCycleStats::StageName(GuideCycleStage stage)
+{
+    switch (stage)
+    {
+        case STAGE_DOWNLOAD:        return "download";
+        case STAGE_DARK:            return "dark";
+        case STAGE_NOISE_REDUCTION: return "noise_reduction";
+        case STAGE_STATS:           return "stats";
+        case STAGE_CENTROID:        return "centroid";
+        case STAGE_ALGORITHM:       return "algorithm";
+        case STAGE_PULSE_ISSUE:     return "pulse_issue";
+        case STAGE_PULSE:           return "pulse";
+        case STAGE_TOTAL:           return "total";
+        default:                    return "unknown";
+    }
+}
+
+wxString GuideCycleStats::StageLabel(GuideCycleStage stage)
+{
+    switch (stage)
+    {
+        case STAGE_DOWNLOAD:        return _("Download");
+        case STAGE_DARK:            return _("Dark/Defects");
+        case STAGE_NOISE_REDUCTION: return _("Noise Reduction");
+        case STAGE_STATS:           return _("Image Stats");
+        case STAGE_CENTROID:        return _("Centroid");
+        case STAGE_ALGORITHM:       return _("Algorithm");
+        case STAGE_PULSE_ISSUE:     return _("Pulse Issue");
+        case STAGE_PULSE:           return _("Pulse");
+        case STAGE_TOTAL:           return _("Total");
+        default:                    return wxEmptyString;
+    }
+}
@@ -0,0 +1,115 @@
+/*
+ *  latency_stats.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2016 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef LATENCY_STATS_H_INCLUDED
+#define LATENCY_STATS_H_INCLUDED
+
+// Keeps the most recent latency samples, in milliseconds, and reports their
+// percentiles. Samples can be added from any thread.
+class LatencyStats
+{
+    enum { MAX_SAMPLES = 512 };
+
+    mutable wxCriticalSection m_lock;
+    double m_samples[MAX_SAMPLES];
+    unsigned int m_count;       // number of valid samples, up to MAX_SAMPLES
+    unsigned int m_next;        // where the next sample goes
+    unsigned int m_total;       // samples added since the last reset
+
+public:
+    LatencyStats(void);
+
+    void Add(double ms);
+    void Reset(void);
+
+    // p50, p95 and p99 of the recent samples; returns the number of samples
+    // they are based on (all zero if there are none)
+    unsigned int GetPercentiles(double *p50, double *p95, double *p99) const;
+    unsigned int TotalSamples(void) const;
+
+    // monotonic microsecond timestamp for measuring intervals
+    static wxLongLong_t Now(void);
+};
+
+// The stages of a guide cycle, from the end of the exposure to the end of
+// the guide pulses it produced
+enum GuideCycleStage
+{
+    STAGE_DOWNLOAD,         // end of exposure until the camera returned the frame
+    STAGE_DARK,             // dark subtraction or defect removal
+    STAGE_NOISE_REDUCTION,
+    STAGE_STATS,            // image statistics
+    STAGE_CENTROID,         // finding the guide star(s)
+    STAGE_ALGORITHM,        // guide algorithms
+    STAGE_PULSE_ISSUE,      // frame analyzed until the first guide pulse starts
+    STAGE_PULSE,            // guide pulses
+    STAGE_TOTAL,            // end of exposure until the guide pulses are complete
+    STAGE_COUNT
+};
+
+// Latency percentiles for each stage of the guide cycle. The stages run on
+// the worker, processing and main threads; each one adds its own samples.
+class GuideCycleStats
+{
+    LatencyStats m_stages[STAGE_COUNT];
+
+    wxCriticalSection m_lock;
+    wxLongLong_t m_exposureEnd;     // of the last analyzed frame, 0 once its guide pulses are recorded
+    wxLongLong_t m_analyzed;
+
+public:
+    GuideCycleStats(void);
+
+    void AddSample(GuideCycleStage stage, wxLongLong_t durationUs);
+
+    // record the timestamps of the frame the next guide pulses are based on
+    void FrameAnalyzed(const usImage& img);
+
+    // record the guide pulses for the last analyzed frame
+    void PulsesComplete(wxLongLong_t pulseStart, wxLongLong_t pulseEnd);
+
+    const LatencyStats& Stage(GuideCycleStage stage) const;
+    void Reset(void);
+
+    static const char *StageName(GuideCycleStage stage);
+    static wxString StageLabel(GuideCycleStage stage);
+};
+
+inline const LatencyStats& GuideCycleStats::Stage(GuideCycleStage stage) const
+{
+    return m_stages[stage];
+}
+
+extern GuideCycleStats CycleStats;
+
+#endif /* LATENCY_STATS_H_INCLUDED */
@@ -34,7 +34,6 @@
  */
 
 #include "phd.h"
-#include "guiding_assistant.h"
 
 #include <wx/tokenzr.h>
 
@@ -470,6 +469,8 @@ Mount::Mount(void)
 
 Mount::~Mount()
 {
+    GuideSteps.Discard(this);
+
     delete m_pXGuideAlgorithm;
     delete m_pYGuideAlgorithm;
 }
@@ -587,6 +588,8 @@ Mount::MOVE_RESULT Mount::Move(const PHD_Point& cameraVectorEndpoint, bool norma
         {
             // Feed the raw distances to the guide algorithms
 
+            wxLongLong_t start = LatencyStats::Now();
+
             if (m_pXGuideAlgorithm)
             {
                 xDistance = m_pXGuideAlgorithm->result(xDistance);
@@ -596,6 +599,8 @@ Mount::MOVE_RESULT Mount::Move(const PHD_Point& cameraVectorEndpoint, bool norma
             {
                 yDistance = m_pYGuideAlgorithm->result(yDistance);
             }
+
+            CycleStats.AddSample(STAGE_ALGORITHM, LatencyStats::Now() - start);
         }
 
         // Figure out the guide directions based on the (possibly) updated distances
@@ -603,44 +608,24 @@ Mount::MOVE_RESULT Mount::Move(const PHD_Point& cameraVectorEndpoint, bool norma
         GUIDE_DIRECTION yDirection = yDistance > 0.0 ? DOWN : UP;
 
         int requestedXAmount = (int) floor(fabs(xDistance / m_xRate) + 0.5);
+        int requestedYAmount = (int) floor(fabs(yDistance / m_cal.yRate) + 0.5);
         MoveResultInfo xMoveResult;
-        result = Move(xDirection, requestedXAmount, normalMove, &xMoveResult);
-
-        wxString msg;
-
-        if (xMoveResult.amountMoved > 0)
-        {
-            msg = wxString::Format(_("%s %5.2f px %3d ms"), xDirection == EAST ? _("East") : _("West"),
-                fabs(xDistance), xMoveResult.amountMoved);
-        }
-
         MoveResultInfo yMoveResult;
-        if (result == MOVE_OK || result == MOVE_ERROR)
-        {
-            int requestedYAmount = (int) floor(fabs(yDistance / m_cal.yRate) + 0.5);
-            result = Move(yDirection, requestedYAmount, normalMove, &yMoveResult);
+        wxLongLong_t pulseStart = LatencyStats::Now();
+        result = MoveAxes(xDirection, requestedXAmount, yDirection, requestedYAmount, normalMove, &xMoveResult, &yMoveResult);
 
-            if (yMoveResult.amountMoved > 0)
-            {
-                msg = wxString::Format(_("%s%*s%s %.2f px %d ms"), msg,
-                    msg.IsEmpty() ? 42 : msg.Len() < 30 ? 30 - msg.Len() : 1, "",
-                    yDirection == SOUTH ? _("South") : _("North"),
-                    fabs(yDistance), yMoveResult.amountMoved);
-            }
-        }
-
-        if (!msg.IsEmpty())
+        if (normalMove && (xMoveResult.amountMoved > 0 || yMoveResult.amountMoved > 0))
         {
-            pFrame->SetStatusText(msg, 1);
-            Debug.AddLine(msg);
+            CycleStats.PulsesComplete(pulseStart, LatencyStats::Now());
         }
 
         GuideStepInfo info;
         info.mount = this;
+        info.normalMove = normalMove;
         info.frameNumber = pFrame->m_frameCounter;
         info.time = pFrame->TimeSinceGuidingStarted();
-        info.cameraOffset = &cameraVectorEndpoint;
-        info.mountOffset = &mountVectorEndpoint;
+        info.cameraOffset = cameraVectorEndpoint;
+        info.mountOffset = mountVectorEndpoint;
         info.guideDistanceRA = xDistance;
         info.guideDistanceDec = yDistance;
         info.durationRA = xMoveResult.amountMoved;
@@ -655,15 +640,8 @@ Mount::MOVE_RESULT Mount::Move(const PHD_Point& cameraVectorEndpoint, bool norma
         info.avgDist = pFrame->pGuider->CurrentError();
         info.starError = pFrame->pGuider->StarError();
 
-        GuideLog.GuideStep(info);
-        EvtServer.NotifyGuideStep(info);
-
-        if (normalMove)
-        {
-            pFrame->pGraphLog->AppendData(info);
-            pFrame->pTarget->AppendData(info);
-            GuidingAssistant::NotifyGuideStep(info);
-        }
+        // the guide log, event server and display are updated on the main thread
+        GuideSteps.Publish(info);
     }
     catch (wxString errMsg)
     {
@@ -674,6 +652,21 @@ Mount::MOVE_RESULT Mount::Move(const PHD_Point& cameraVectorEndpoint, bool norma
     return result;
 }
 
+// Move both axes, one after the other. Mounts that can guide both axes at
+// the same time override this.
+Mount::MOVE_RESULT Mount::MoveAxes(GUIDE_DIRECTION xDirection, int xAmount, GUIDE_DIRECTION yDirection, int yAmount,
+                                   bool normalMove, MoveResultInfo *xMoveResult, MoveResultInfo *yMoveResult)
+{
+    MOVE_RESULT result = Move(xDirection, xAmount, normalMove, xMoveResult);
+
+    if (result == MOVE_OK || result == MOVE_ERROR)
+    {
+        result = Move(yDirection, yAmount, normalMove, yMoveResult);
+    }
+
+    return result;
+}
+
 /*
  * The transform code has proven really tricky to get right.  For future generations
  * (and for me the next time I try to work on it), I'm going to put some notes here.
@@ -893,11 +886,14 @@ void Mount::AdjustCalibrationForScopePointing(void)
 
 bool Mount::IsBusy(void)
 {
+    wxCriticalSectionLocker lock(m_requestCountLock);
     return m_requestCount > 0;
 }
 
 void Mount::IncrementRequestCount(void)
 {
+    wxCriticalSectionLocker lock(m_requestCountLock);
+
     m_requestCount++;
 
     // for the moment we never enqueue requests if the mount is busy, but we can
@@ -909,6 +905,8 @@ void Mount::IncrementRequestCount(void)
 
 void Mount::DecrementRequestCount(void)
 {
+    wxCriticalSectionLocker lock(m_requestCountLock);
+
     assert(m_requestCount > 0);
     m_requestCount--;
 }
@@ -1166,6 +1164,11 @@ bool Mount::Connect(void)
 
 bool Mount::Disconnect(void)
 {
+    // steps still waiting for the main thread refer to this mount: deliver
+    // them if this is the main thread, and drop any that are left
+    GuideSteps.Dispatch();
+    GuideSteps.Discard(this);
+
     m_connected = false;
     if (pFrame) pFrame->UpdateCalibrationStatus();
 
@@ -98,6 +98,7 @@ class Mount : public wxMessageBoxProxy
 {
     bool m_connected;
     int m_requestCount;
+    wxCriticalSection m_requestCountLock;   // AO bumps are scheduled from a worker thread
 
     bool m_calibrated;
     Calibration m_cal;
@@ -179,6 +180,8 @@ public:
     void SetGuidingEnabled(bool guidingEnabled);
 
     virtual MOVE_RESULT Move(const PHD_Point& cameraVectorEndpoint, bool normalMove=true);
+    virtual MOVE_RESULT MoveAxes(GUIDE_DIRECTION xDirection, int xAmount, GUIDE_DIRECTION yDirection, int yAmount,
+                                 bool normalMove, MoveResultInfo *xMoveResult, MoveResultInfo *yMoveResult);
     bool TransformCameraCoordinatesToMountCoordinates(const PHD_Point& cameraVectorEndpoint,
                                                       PHD_Point& mountVectorEndpoint);
 
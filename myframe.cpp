@@ -49,11 +49,15 @@
 #include <memory>
 
 static const int DefaultNoiseReductionMethod = 0;
+static const int DefaultCentroidMethod = CM_CENTROID;
 static const double DefaultDitherScaleFactor = 1.00;
 static const bool DefaultDitherRaOnly = false;
 static const bool DefaultServerMode = true;
 static const bool DefaultLoggingMode = false;
 static const int DefaultTimelapse = 0;
+static const int DefaultMaxFrameAge = 2000;
+static const int DefaultUIRefreshRate = 10;
+static const int MaxUIRefreshRate = 60;
 static const int DefaultFocalLength = 0;
 static const int DefaultAutoExpMin = 1000;
 static const int DefaultAutoExpMax = 5000;
@@ -83,6 +87,7 @@ BEGIN_EVENT_TABLE(MyFrame, wxFrame)
     EVT_MENU(wxID_HELP_PROCEDURES, MyFrame::OnInstructions)
     EVT_MENU(wxID_HELP_CONTENTS,MyFrame::OnHelp)
     EVT_MENU(wxID_SAVE, MyFrame::OnSave)
+    EVT_MENU(MENU_FLIGHTRECORDER_SAVE, MyFrame::OnSaveFlightRecorder)
     EVT_MENU(MENU_TAKEDARKS,MyFrame::OnDark)
     EVT_MENU(MENU_LOADDARK,MyFrame::OnLoadDark)
     EVT_MENU(MENU_LOADDEFECTMAP,MyFrame::OnLoadDefectMap)
@@ -162,14 +167,23 @@ MyFrame::MyFrame(int instanceNumber, wxLocale *locale)
     m_instanceNumber = instanceNumber;
     m_pLocale = locale;
 
+    FlightRec.SetInstanceNumber(instanceNumber);
+
     m_mgr.SetManagedWindow(this);
 
     m_frameCounter = 0;
     m_loggedImageFrame = 0;
+    m_pipelinedExposures = false;
+    m_maxFrameAge = DefaultMaxFrameAge;
+    m_starFindMode = Star::FIND_CENTROID;
+    m_centroidMethod = CM_CENTROID;
+    m_staleFramesDropped = 0;
     m_pPrimaryWorkerThread = NULL;
     StartWorkerThread(m_pPrimaryWorkerThread);
     m_pSecondaryWorkerThread = NULL;
     StartWorkerThread(m_pSecondaryWorkerThread);
+    m_pProcessingThread = NULL;
+    StartProcessingThread();
 
     m_statusbarTimer.SetOwner(this, STATUSBAR_TIMER_EVENT);
 
@@ -218,7 +232,7 @@ MyFrame::MyFrame(int instanceNumber, wxLocale *locale)
 
     sizer->Add(m_infoBar, wxSizerFlags().Expand());
 
-    pGuider = new GuiderOneStar(guiderWin);
+    pGuider = new GuiderMultiStar(guiderWin);
     sizer->Add(pGuider, wxSizerFlags().Proportion(1).Expand());
 
     guiderWin->SetSizer(sizer);
@@ -305,7 +319,6 @@ MyFrame::MyFrame(int instanceNumber, wxLocale *locale)
     pRefineDefMap = NULL;
     pCalSanityCheckDlg = NULL;
     pCalReviewDlg = NULL;
-    m_starFindMode = Star::FIND_CENTROID;
     m_rawImageMode = false;
     m_rawImageModeWarningDone = false;
 
@@ -335,6 +348,7 @@ MyFrame::MyFrame(int instanceNumber, wxLocale *locale)
     m_continueCapturing = false;
     CaptureActive     = false;
     m_exposurePending = false;
+    m_pipelinedExposurePending = false;
 
     m_mgr.GetArtProvider()->SetMetric(wxAUI_DOCKART_GRADIENT_TYPE, wxAUI_GRADIENT_VERTICAL);
     m_mgr.GetArtProvider()->SetColor(wxAUI_DOCKART_INACTIVE_CAPTION_COLOUR, wxColour(0, 153, 255));
@@ -380,10 +394,14 @@ MyFrame::MyFrame(int instanceNumber, wxLocale *locale)
     Menubar->Check(MENU_TARGET, panel_state);
 
     m_mgr.Update();
+
+    m_uiRefresh.Start();
 }
 
 MyFrame::~MyFrame()
 {
+    m_uiRefresh.Stop();
+
     delete pGearDialog;
     pGearDialog = NULL;
 
@@ -430,6 +448,7 @@ void MyFrame::SetupMenuBar(void)
     wxMenu *file_menu = new wxMenu;
     file_menu->AppendSeparator();
     file_menu->Append(wxID_SAVE, _("&Save Image..."), _("Save current image"));
+    file_menu->Append(MENU_FLIGHTRECORDER_SAVE, _("Save &Flight Recorder Frames"), _("Save the frames kept by the flight recorder to a FITS file in the log directory"));
     file_menu->Append(wxID_EXIT, _("E&xit\tAlt-X"), _("Quit this program"));
 
     tools_menu = new wxMenu;
@@ -717,6 +736,9 @@ void MyFrame::LoadProfileSettings(void)
     int noiseReductionMethod = pConfig->Profile.GetInt("/NoiseReductionMethod", DefaultNoiseReductionMethod);
     SetNoiseReductionMethod(noiseReductionMethod);
 
+    int centroidMethod = pConfig->Profile.GetInt("/CentroidMethod", DefaultCentroidMethod);
+    SetCentroidMethod(centroidMethod);
+
     double ditherScaleFactor = pConfig->Profile.GetDouble("/DitherScaleFactor", DefaultDitherScaleFactor);
     SetDitherScaleFactor(ditherScaleFactor);
 
@@ -728,6 +750,16 @@ void MyFrame::LoadProfileSettings(void)
 
     SetAutoLoadCalibration(pConfig->Profile.GetBoolean("/AutoLoadCalibration", false));
 
+    SetPipelinedExposures(pConfig->Profile.GetBoolean("/frame/pipelinedExposures", false));
+
+    SetMaxFrameAge(pConfig->Profile.GetInt("/frame/maxFrameAge", DefaultMaxFrameAge));
+
+    SetUIRefreshRate(pConfig->Profile.GetInt("/frame/uiRefreshRate", DefaultUIRefreshRate));
+
+    FlightRec.LoadProfileSettings();
+
+    ImgWriter.LoadProfileSettings();
+
     int focalLength = pConfig->Profile.GetInt("/frame/focalLength", DefaultFocalLength);
     SetFocalLength(focalLength);
 
@@ -1192,6 +1224,63 @@ bool MyFrame::StopWorkerThread(WorkerThread*& pWorkerThread)
     return killed;
 }
 
+bool MyFrame::StartProcessingThread(void)
+{
+    bool bError = false;
+    wxCriticalSectionLocker lock(m_CSpProcessingThread);
+
+    try
+    {
+        ProcessingThread *thread = new ProcessingThread(this);
+
+        if (thread->Create() != wxTHREAD_NO_ERROR || thread->Run() != wxTHREAD_NO_ERROR)
+        {
+            delete thread;
+            throw ERROR_INFO("Could not start the processing thread");
+        }
+
+        m_pProcessingThread = thread;
+    }
+    catch (wxString Msg)
+    {
+        POSSIBLY_UNUSED(Msg);
+        bError = true;
+    }
+
+    return bError;
+}
+
+void MyFrame::StopProcessingThread(void)
+{
+    wxCriticalSectionLocker lock(m_CSpProcessingThread);
+
+    if (m_pProcessingThread)
+    {
+        // frames already queued are analysed before the thread exits; it
+        // never waits on the main thread so it is safe to block here
+        m_pProcessingThread->EnqueueTerminateRequest();
+        m_pProcessingThread->Wait();
+        delete m_pProcessingThread;
+        m_pProcessingThread = NULL;
+    }
+}
+
+// Called on the primary worker thread with a completed exposure. Returns true
+// if there is no processing thread, in which case the caller sends the
+// expose complete event itself and the frame is analysed on the main thread.
+bool MyFrame::ScheduleFrameAnalysis(usImage *pImage, bool bError)
+{
+    wxCriticalSectionLocker lock(m_CSpProcessingThread);
+
+    if (!m_pProcessingThread)
+    {
+        return true;
+    }
+
+    m_pProcessingThread->EnqueueFrame(pImage, bError);
+    return false;
+}
+
 void MyFrame::OnRequestExposure(wxCommandEvent& evt)
 {
     EXPOSE_REQUEST *req = (EXPOSE_REQUEST *) evt.GetClientData();
@@ -1226,18 +1315,56 @@ void MyFrame::OnStatusbarTimerEvent(wxTimerEvent& evt)
 
 void MyFrame::ScheduleExposure(void)
 {
-    int exposureDuration = RequestedExposureDuration();
-    int exposureOptions = GetRawImageMode() ? CAPTURE_BPM_REVIEW : CAPTURE_LIGHT;
-    const wxRect& subframe = pGuider->GetBoundingBox();
-
-    Debug.AddLine("ScheduleExposure(%d,%x,%d) exposurePending=%d",
-        exposureDuration, exposureOptions, !subframe.IsEmpty(), m_exposurePending);
+    Debug.AddLine("ScheduleExposure exposurePending=%d", m_exposurePending);
 
     assert(wxThread::IsMain()); // m_exposurePending only updated in main thread
     assert(!m_exposurePending);
 
     m_exposurePending = true;
 
+    EnqueueExposure();
+}
+
+/*
+ * With pipelined exposures the next exposure is queued behind the one in
+ * progress, so the camera starts it as soon as the current one completes.
+ * Guide moves then run on the secondary worker thread, overlapping the next
+ * exposure, instead of waiting behind it on the primary worker thread.
+ */
+void MyFrame::SchedulePipelinedExposure(void)
+{
+    Debug.AddLine("SchedulePipelinedExposure exposurePending=%d", m_exposurePending);
+
+    assert(wxThread::IsMain());
+    assert(m_exposurePending && !m_pipelinedExposurePending);
+
+    m_pipelinedExposurePending = true;
+
+    EnqueueExposure();
+}
+
+bool MyFrame::CanPipelineExposures(void)
+{
+    // calibration needs each frame to be taken after the preceding move;
+    // mounts that move through the camera cannot move during an exposure;
+    // a streaming camera is already exposing while the last frame is processed;
+    // AO steps would have to wait behind the mount bumps on the secondary
+    // worker thread, or behind the exposure on the primary one
+    return m_pipelinedExposures &&
+        pGuider->IsGuiding() && !pGuider->IsPaused() &&
+        pCamera && pCamera->HasNonGuiCapture() && !pCamera->HasStreaming() &&
+        (!pMount || (!pMount->SynchronousOnly() && !pMount->IsStepGuider())) &&
+        (!pSecondaryMount || !pSecondaryMount->SynchronousOnly());
+}
+
+void MyFrame::EnqueueExposure(void)
+{
+    int exposureDuration = RequestedExposureDuration();
+    int exposureOptions = GetRawImageMode() ? CAPTURE_BPM_REVIEW : CAPTURE_LIGHT;
+    const wxRect& subframe = pGuider->GetBoundingBox();
+
+    Debug.AddLine("EnqueueExposure(%d,%x,%d)", exposureDuration, exposureOptions, !subframe.IsEmpty());
+
     usImage *img = new usImage();
 
     wxCriticalSectionLocker lock(m_CSpWorkerThread);
@@ -1254,6 +1381,14 @@ void MyFrame::SchedulePrimaryMove(Mount *pMount, const PHD_Point& vectorEndpoint
     assert(pMount);
     pMount->IncrementRequestCount();
 
+    // while a pipelined exposure is in progress the primary worker thread is
+    // busy with it, so move on the secondary thread
+    if (m_exposurePending && CanPipelineExposures() && m_pSecondaryWorkerThread)
+    {
+        m_pSecondaryWorkerThread->EnqueueWorkerThreadMoveRequest(pMount, vectorEndpoint, normalMove);
+        return;
+    }
+
     assert(m_pPrimaryWorkerThread);
     m_pPrimaryWorkerThread->EnqueueWorkerThreadMoveRequest(pMount, vectorEndpoint, normalMove);
 }
@@ -1522,6 +1657,9 @@ void MyFrame::OnClose(wxCloseEvent& event)
 
     StopCapturing();
 
+    // stop this first; it schedules moves on the worker threads
+    StopProcessingThread();
+
     bool killed = StopWorkerThread(m_pPrimaryWorkerThread);
     if (StopWorkerThread(m_pSecondaryWorkerThread))
         killed = true;
@@ -1534,6 +1672,11 @@ void MyFrame::OnClose(wxCloseEvent& event)
 
     GuideLog.Close();
 
+    // finish writing any saved images
+    ImgWriter.Stop();
+
+    m_uiRefresh.Stop();
+
     pConfig->Global.SetString("/perspective", m_mgr.SavePerspective());
     wxString geometry = wxString::Format("%c;%d;%d;%d;%d",
         this->IsMaximized() ? '1' : '0',
@@ -1582,6 +1725,44 @@ bool MyFrame::SetNoiseReductionMethod(int noiseReductionMethod)
     return bError;
 }
 
+CENTROID_METHOD MyFrame::GetCentroidMethod(void)
+{
+    return m_centroidMethod;
+}
+
+bool MyFrame::SetCentroidMethod(int centroidMethod)
+{
+    bool bError = false;
+
+    try
+    {
+        switch (centroidMethod)
+        {
+            case CM_CENTROID:
+            case CM_PSF_GAUSSIAN:
+            case CM_PSF_MOFFAT:
+                break;
+            default:
+                throw ERROR_INFO("invalid centroidMethod");
+        }
+        m_centroidMethod = (CENTROID_METHOD)centroidMethod;
+    }
+    catch (wxString Msg)
+    {
+        POSSIBLY_UNUSED(Msg);
+
+        bError = true;
+        m_centroidMethod = (CENTROID_METHOD)DefaultCentroidMethod;
+    }
+
+    Star::SetPsfModel(m_centroidMethod == CM_PSF_MOFFAT ? PSF_MOFFAT : PSF_GAUSSIAN);
+    SetStarFindMode(m_centroidMethod == CM_CENTROID ? Star::FIND_CENTROID : Star::FIND_PSF_FIT);
+
+    pConfig->Profile.SetInt("/CentroidMethod", m_centroidMethod);
+
+    return bError;
+}
+
 double MyFrame::GetDitherScaleFactor(void)
 {
     return m_ditherScaleFactor;
@@ -1627,6 +1808,81 @@ bool MyFrame::SetDitherRaOnly(bool ditherRaOnly)
     return bError;
 }
 
+void MyFrame::SetPipelinedExposures(bool enable)
+{
+    m_pipelinedExposures = enable;
+    pConfig->Profile.SetBoolean("/frame/pipelinedExposures", m_pipelinedExposures);
+}
+
+bool MyFrame::SetMaxFrameAge(int maxFrameAge)
+{
+    bool bError = false;
+
+    try
+    {
+        if (maxFrameAge < 0)
+        {
+            throw ERROR_INFO("maxFrameAge < 0");
+        }
+
+        m_maxFrameAge = maxFrameAge;
+    }
+    catch (wxString Msg)
+    {
+        POSSIBLY_UNUSED(Msg);
+        bError = true;
+        m_maxFrameAge = DefaultMaxFrameAge;
+    }
+
+    pConfig->Profile.SetInt("/frame/maxFrameAge", m_maxFrameAge);
+
+    return bError;
+}
+
+bool MyFrame::SetUIRefreshRate(int rate)
+{
+    bool bError = false;
+
+    try
+    {
+        if (rate < 0 || rate > MaxUIRefreshRate)
+        {
+            throw ERROR_INFO("invalid UI refresh rate");
+        }
+    }
+    catch (wxString Msg)
+    {
+        POSSIBLY_UNUSED(Msg);
+        bError = true;
+        rate = DefaultUIRefreshRate;
+    }
+
+    m_uiRefresh.SetRate(rate);
+    pConfig->Profile.SetInt("/frame/uiRefreshRate", rate);
+
+    return bError;
+}
+
+// Is the frame too old to guide from? Called on the processing thread before
+// a frame is analysed and on the main thread for frames it analyses itself.
+bool MyFrame::IsFrameStale(const usImage *pImage) const
+{
+    int maxAge = m_maxFrameAge;
+    if (maxAge == 0 || !pImage->ImgCapturedUs)
+        return false;
+
+    return LatencyStats::Now() - pImage->ImgCapturedUs > (wxLongLong_t) maxAge * 1000;
+}
+
+void MyFrame::NotifyStaleFrameDropped(const usImage *pImage)
+{
+    ++m_staleFramesDropped;
+
+    double age = (double) (LatencyStats::Now() - pImage->ImgCapturedUs) / 1000.0;
+    Debug.AddLine("Dropped stale frame, age = %.0f ms, %u dropped", age, m_staleFramesDropped);
+    GuideLog.NotifyStaleFrameDropped(age, m_staleFramesDropped);
+}
+
 bool MyFrame::GetAutoLoadCalibration(void)
 {
     return m_autoLoadCalibration;
@@ -2100,11 +2356,12 @@ wxString MyFrame::PixelScaleSummary(void) const
 wxString MyFrame::GetSettingsSummary()
 {
     // return a loggable summary of current global configs managed by MyFrame
-    return wxString::Format("Dither = %s, Dither scale = %.3f, Image noise reduction = %s, Guide-frame time lapse = %d, Server %s\n"
+    return wxString::Format("Dither = %s, Dither scale = %.3f, Image noise reduction = %s, Centroid = %s, Guide-frame time lapse = %d, Server %s\n"
         "%s\n",
         m_ditherRaOnly ? "RA only" : "both axes",
         m_ditherScaleFactor,
         m_noiseReductionMethod == NR_NONE ? "none" : m_noiseReductionMethod == NR_2x2MEAN ? "2x2 mean" : "3x3 mean",
+        m_centroidMethod == CM_CENTROID ? "centroid" : m_centroidMethod == CM_PSF_GAUSSIAN ? "Gaussian PSF fit" : "Moffat PSF fit",
         m_timeLapse,
         m_serverMode ? "enabled" : "disabled",
         PixelScaleSummary()
@@ -2193,12 +2450,55 @@ MyFrameConfigDialogPane::MyFrameConfigDialogPane(wxWindow *pParent, MyFrame *pFr
     DoAdd(_("Noise Reduction"), m_pNoiseReduction,
           _("Technique to reduce noise in images"));
 
+    wxString centroid_choices[] =
+    {
+        _("Centroid"),_("Gaussian PSF fit"),_("Moffat PSF fit")
+    };
+
+    width = StringArrayWidth(centroid_choices, WXSIZEOF(centroid_choices));
+    m_pCentroidMethod = new wxChoice(pParent, wxID_ANY, wxPoint(-1,-1),
+            wxSize(width+35, -1), WXSIZEOF(centroid_choices), centroid_choices );
+    DoAdd(_("Star position"), m_pCentroidMethod,
+          _("How the guide star position is measured. The PSF fits are more accurate than the centroid for small (undersampled) stars "
+            "but take more processing time. Default = Centroid"));
+
     width = StringWidth(_T("00000"));
     m_pTimeLapse = new wxSpinCtrl(pParent, wxID_ANY,_T("foo2"), wxPoint(-1,-1),
             wxSize(width+30, -1), wxSP_ARROW_KEYS, 0, 10000, 0, _T("TimeLapse"));
     DoAdd(_("Time Lapse (ms)"), m_pTimeLapse,
           _("How long should PHD wait between guide frames? Default = 0ms, useful when using very short exposures (e.g., using a video camera) but wanting to send guide commands less frequently"));
 
+    m_pPipelinedExposures = new wxCheckBox(pParent, wxID_ANY, _("Pipelined exposures"));
+    DoAdd(m_pPipelinedExposures, _("While guiding, start the next exposure as soon as the current one completes, "
+        "and send guide corrections while it is being taken. Shortens the time between frames, "
+        "but frames may be taken while the mount is moving. Not used with on-camera mount connections or adaptive optics. Default = unchecked"));
+
+    m_pMaxFrameAge = new wxSpinCtrl(pParent, wxID_ANY, _T("foo2"), wxPoint(-1, -1),
+            wxSize(width + 30, -1), wxSP_ARROW_KEYS, 0, 60000, 0, _T("MaxFrameAge"));
+    DoAdd(_("Max frame age (ms)"), m_pMaxFrameAge,
+          wxString::Format(_("Frames that are not analyzed within this time of being captured, because PHD2 has fallen behind, "
+            "are dropped and not used for guiding. 0 = no limit. Default = %d ms"), DefaultMaxFrameAge));
+
+    m_pUIRefreshRate = new wxSpinCtrl(pParent, wxID_ANY, _T("foo2"), wxPoint(-1, -1),
+            wxSize(width + 30, -1), wxSP_ARROW_KEYS, 0, MaxUIRefreshRate, 0, _T("UIRefreshRate"));
+    DoAdd(_("Display refresh rate (per second)"), m_pUIRefreshRate,
+          wxString::Format(_("How many times a second the graph, target, stats and star profile windows are redrawn while guiding. "
+            "Lower values leave more time for guiding with short exposures. 0 = redraw on every guide step. Default = %d"), DefaultUIRefreshRate));
+
+    m_pFlightRecorder = new wxCheckBox(pParent, wxID_ANY, _("Flight recorder"));
+    DoAdd(m_pFlightRecorder, _("Keep the region around the guide star of recent frames in a file in the log directory. "
+        "The frames are saved to a FITS file when the star is lost, when calibration fails, from the File menu, "
+        "and at the next start if PHD2 did not exit normally. Default = unchecked"));
+
+    m_pFlightRecorderSize = new wxSpinCtrl(pParent, wxID_ANY, _T("foo2"), wxPoint(-1, -1),
+            wxSize(width + 30, -1), wxSP_ARROW_KEYS, 4, 1024, 64, _T("FlightRecorderSize"));
+    DoAdd(_("Flight recorder size (MB)"), m_pFlightRecorderSize,
+          _("Size of the flight recorder file. Each frame takes about 32 KB. Default = 64 MB"));
+
+    m_pCompressImages = new wxCheckBox(pParent, wxID_ANY, _("Compress saved images"));
+    DoAdd(m_pCompressImages, _("Save images with lossless Rice compression (like fpack). The files are smaller but "
+        "some programs cannot open compressed FITS files. Default = unchecked"));
+
     m_pFocalLength = new wxTextCtrl(pParent, wxID_ANY, _T("    "), wxDefaultPosition, wxSize(width+30, -1));
     DoAdd( _("Focal length (mm)"), m_pFocalLength,
            _("Guider telescope focal length, used with the camera pixel size to display guiding error in arc-sec."));
@@ -2302,9 +2602,16 @@ void MyFrameConfigDialogPane::LoadValues(void)
     m_pResetDontAskAgain->SetValue(false);
     m_pLoggedImageFormat->SetSelection(m_pFrame->GetLoggedImageFormat());
     m_pNoiseReduction->SetSelection(m_pFrame->GetNoiseReductionMethod());
+    m_pCentroidMethod->SetSelection(m_pFrame->GetCentroidMethod());
     m_pDitherRaOnly->SetValue(m_pFrame->GetDitherRaOnly());
     m_pDitherScaleFactor->SetValue(m_pFrame->GetDitherScaleFactor());
     m_pTimeLapse->SetValue(m_pFrame->GetTimeLapse());
+    m_pPipelinedExposures->SetValue(m_pFrame->GetPipelinedExposures());
+    m_pMaxFrameAge->SetValue(m_pFrame->GetMaxFrameAge());
+    m_pUIRefreshRate->SetValue(m_pFrame->GetUIRefreshRate());
+    m_pFlightRecorder->SetValue(FlightRec.GetEnabled());
+    m_pFlightRecorderSize->SetValue(FlightRec.GetSizeMb());
+    m_pCompressImages->SetValue(ImgWriter.GetCompress());
     SetFocalLength(m_pFrame->GetFocalLength());
     m_pFocalLength->Enable(!pFrame->CaptureActive);
 
@@ -2355,9 +2662,19 @@ void MyFrameConfigDialogPane::UnloadValues(void)
 
         m_pFrame->SetLoggedImageFormat((LOGGED_IMAGE_FORMAT) m_pLoggedImageFormat->GetSelection());
         m_pFrame->SetNoiseReductionMethod(m_pNoiseReduction->GetSelection());
+        m_pFrame->SetCentroidMethod(m_pCentroidMethod->GetSelection());
         m_pFrame->SetDitherRaOnly(m_pDitherRaOnly->GetValue());
         m_pFrame->SetDitherScaleFactor(m_pDitherScaleFactor->GetValue());
         m_pFrame->SetTimeLapse(m_pTimeLapse->GetValue());
+        m_pFrame->SetPipelinedExposures(m_pPipelinedExposures->GetValue());
+        m_pFrame->SetMaxFrameAge(m_pMaxFrameAge->GetValue());
+        m_pFrame->SetUIRefreshRate(m_pUIRefreshRate->GetValue());
+        FlightRec.SetSizeMb(m_pFlightRecorderSize->GetValue());
+        if (FlightRec.SetEnabled(m_pFlightRecorder->GetValue()))
+        {
+            wxMessageBox(_("The flight recorder file could not be created in the log directory."), _("Error"), wxOK | wxICON_ERROR);
+        }
+        ImgWriter.SetCompress(m_pCompressImages->GetValue());
 
         m_pFrame->SetFocalLength(GetFocalLength());
 
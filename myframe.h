@@ -38,6 +38,7 @@
 #define MYFRAME_H_INCLUDED
 
 class WorkerThread;
+class ProcessingThread;
 class MyFrame;
 class RefineDefMap;
 struct alert_params;
@@ -63,6 +64,13 @@ enum NOISE_REDUCTION_METHOD
     NR_3x3MEDIAN
 };
 
+enum CENTROID_METHOD
+{
+    CM_CENTROID,
+    CM_PSF_GAUSSIAN,
+    CM_PSF_MOFFAT
+};
+
 enum LOGGED_IMAGE_FORMAT
 {
     LIF_LOW_Q_JPEG,
@@ -89,7 +97,14 @@ class MyFrameConfigDialogPane : public ConfigDialogPane
     wxCheckBox *m_pDitherRaOnly;
     wxSpinCtrlDouble *m_pDitherScaleFactor;
     wxChoice *m_pNoiseReduction;
+    wxChoice *m_pCentroidMethod;
     wxSpinCtrl *m_pTimeLapse;
+    wxCheckBox *m_pPipelinedExposures;
+    wxSpinCtrl *m_pMaxFrameAge;
+    wxSpinCtrl *m_pUIRefreshRate;
+    wxCheckBox *m_pFlightRecorder;
+    wxSpinCtrl *m_pFlightRecorderSize;
+    wxCheckBox *m_pCompressImages;
     wxTextCtrl *m_pFocalLength;
     wxChoice* m_pLanguage;
     wxArrayInt m_LanguageIDs;
@@ -120,12 +135,23 @@ protected:
     NOISE_REDUCTION_METHOD GetNoiseReductionMethod(void);
     bool SetNoiseReductionMethod(int noiseReductionMethod);
 
+    CENTROID_METHOD GetCentroidMethod(void);
+    bool SetCentroidMethod(int centroidMethod);
+
     bool GetServerMode(void);
     bool SetServerMode(bool val);
 
     bool SetTimeLapse(int timeLapse);
     int GetTimeLapse(void);
 
+    void SetPipelinedExposures(bool enable);
+
+    bool SetMaxFrameAge(int maxFrameAge);
+    int GetMaxFrameAge(void) const;
+
+    bool SetUIRefreshRate(int rate);
+    int GetUIRefreshRate(void) const;
+
     bool SetFocalLength(int focalLength);
 
     bool SetLanguage(int language);
@@ -137,12 +163,16 @@ protected:
 
 private:
     NOISE_REDUCTION_METHOD m_noiseReductionMethod;
+    CENTROID_METHOD m_centroidMethod;
     bool m_image_logging_enabled;
     LOGGED_IMAGE_FORMAT m_logged_image_format;
     double m_ditherScaleFactor;
     bool m_ditherRaOnly;
     bool m_serverMode;
     int  m_timeLapse;       // Delay between frames (useful for vid cameras)
+    bool m_pipelinedExposures; // start the next exposure while the current frame is processed
+    int  m_maxFrameAge;     // frames older than this (ms) are not used for guiding, 0 = no limit
+    unsigned int m_staleFramesDropped;
     int  m_focalLength;
     double m_sampling;
     bool m_autoLoadCalibration;
@@ -192,6 +222,7 @@ public:
     wxDialog *pCalReviewDlg;
     bool CaptureActive; // Is camera looping captures?
     bool m_exposurePending; // exposure scheduled and not completed
+    bool m_pipelinedExposurePending; // a second exposure is queued behind the pending one
     double Stretch_gamma;
     wxLocale *m_pLocale;
     unsigned int m_frameCounter;
@@ -200,6 +231,7 @@ public:
     Star::FindMode m_starFindMode;
     bool m_rawImageMode;
     bool m_rawImageModeWarningDone;
+    UIRefreshScheduler m_uiRefresh;
 
     void RegisterTextCtrl(wxTextCtrl *ctrl);
     void OnQuit(wxCommandEvent& evt);
@@ -210,6 +242,7 @@ public:
     void OnOverlaySlitCoords(wxCommandEvent& evt);
     void OnInstructions(wxCommandEvent& evt);
     void OnSave(wxCommandEvent& evt);
+    void OnSaveFlightRecorder(wxCommandEvent& evt);
     void OnSettings(wxCommandEvent& evt);
     void OnLog(wxCommandEvent& evt);
     void OnSelectGear(wxCommandEvent& evt);
@@ -285,6 +318,7 @@ public:
     Star::FindMode GetStarFindMode(void) const;
     Star::FindMode SetStarFindMode(Star::FindMode mode);
     bool GetRawImageMode(void) const;
+    bool ContinueCapturing(void) const;
     bool SetRawImageMode(bool force);
 
     bool StartServer(bool state);
@@ -335,6 +369,12 @@ public:
     void OnRequestMountMove(wxCommandEvent& evt);
 
     void ScheduleExposure(void);
+    void SchedulePipelinedExposure(void);
+    bool CanPipelineExposures(void);
+    bool GetPipelinedExposures(void) const;
+    bool IsFrameStale(const usImage *pImage) const;
+    void NotifyStaleFrameDropped(const usImage *pImage);
+    bool ScheduleFrameAnalysis(usImage *pImage, bool bError);
 
     void SchedulePrimaryMove(Mount *pMount, const PHD_Point& vectorEndpoint, bool normalMove=true);
     void ScheduleSecondaryMove(Mount *pMount, const PHD_Point& vectorEndpoint, bool normalMove=true);
@@ -368,6 +408,8 @@ private:
     wxCriticalSection m_CSpWorkerThread;
     WorkerThread *m_pPrimaryWorkerThread;
     WorkerThread *m_pSecondaryWorkerThread;
+    wxCriticalSection m_CSpProcessingThread;
+    ProcessingThread *m_pProcessingThread;
 
     wxSocketServer *SocketServer;
 
@@ -381,6 +423,9 @@ private:
 
     bool StartWorkerThread(WorkerThread*& pWorkerThread);
     bool StopWorkerThread(WorkerThread*& pWorkerThread);
+    void EnqueueExposure(void);
+    bool StartProcessingThread(void);
+    void StopProcessingThread(void);
     void OnSetStatusText(wxThreadEvent& event);
     void DoAlert(const alert_params& params);
     void OnAlertButton(wxCommandEvent& evt);
@@ -508,6 +553,7 @@ enum {
     MENU_GUIDING_ASSISTANT,
     MENU_SAVESETTINGS,
     MENU_LOADSETTINGS,
+    MENU_FLIGHTRECORDER_SAVE,
     MENU_LOADDARK,
     MENU_LOADDEFECTMAP,
     MENU_REFINEDEFECTMAP,
@@ -548,6 +594,7 @@ enum {
     EEGG_STICKY_LOCK,
     EEGG_FLIPRACAL,
     STAR_MASS_ENABLE,
+    MULTISTAR_ENABLE,
     MENU_BOOKMARKS_SHOW,
     MENU_BOOKMARKS_SET_AT_LOCK,
     MENU_BOOKMARKS_SET_AT_STAR,
@@ -595,4 +642,24 @@ inline bool MyFrame::GetRawImageMode(void) const
     return m_rawImageMode;
 }
 
+inline bool MyFrame::ContinueCapturing(void) const
+{
+    return m_continueCapturing;
+}
+
+inline bool MyFrame::GetPipelinedExposures(void) const
+{
+    return m_pipelinedExposures;
+}
+
+inline int MyFrame::GetMaxFrameAge(void) const
+{
+    return m_maxFrameAge;
+}
+
+inline int MyFrame::GetUIRefreshRate(void) const
+{
+    return m_uiRefresh.GetRate();
+}
+
 #endif /* MYFRAME_H_INCLUDED */
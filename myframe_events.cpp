@@ -259,6 +259,25 @@ void MyFrame::OnSave(wxCommandEvent& WXUNUSED(event))
     }
 }
 
+void MyFrame::OnSaveFlightRecorder(wxCommandEvent& WXUNUSED(event))
+{
+    if (!FlightRec.GetEnabled())
+    {
+        Alert(_("The flight recorder is not enabled. It can be enabled in the Global tab of the Advanced Settings."));
+        return;
+    }
+
+    wxString fname;
+    if (FlightRec.Dump("requested", &fname))
+    {
+        Alert(_("The flight recorder frames could not be saved"));
+    }
+    else
+    {
+        pFrame->SetStatusText(wxString::Format(_("%s saved"), wxFileName(fname).GetFullName()));
+    }
+}
+
 void MyFrame::OnIdle(wxIdleEvent& WXUNUSED(event))
 {
 /*  if (ASCOM_IsMoving())
@@ -295,6 +314,8 @@ void MyFrame::FinishStop(void)
     // when looping resumes, start with at least one full frame. This enables applications
     // controlling PHD to auto-select a new star if the star is lost while looping was stopped.
     assert(!CaptureActive);
+    if (pCamera)
+        pCamera->StopStream();
     pGuider->ForceFullFrame();
     ResetAutoExposure();
     UpdateButtonsStatus();
@@ -342,7 +363,15 @@ void MyFrame::OnExposeComplete(wxThreadEvent& event)
     {
         Debug.AddLine("Processing an image");
 
-        m_exposurePending = false;
+        if (m_pipelinedExposurePending)
+        {
+            // the next exposure is already in progress
+            m_pipelinedExposurePending = false;
+        }
+        else
+        {
+            m_exposurePending = false;
+        }
 
         usImage *pNewFrame = event.GetPayload<usImage *>();
 
@@ -357,6 +386,14 @@ void MyFrame::OnExposeComplete(wxThreadEvent& event)
         {
             delete pNewFrame;
 
+            if (m_exposurePending)
+            {
+                // stop the pipelined exposure too; the stop completes when it does
+                Debug.AddLine("Capture error with a pipelined exposure pending");
+                StopCapturing();
+                return;
+            }
+
             StopCapturing();
             if (pGuider->IsCalibratingOrGuiding())
             {
@@ -377,27 +414,55 @@ void MyFrame::OnExposeComplete(wxThreadEvent& event)
 
             throw ERROR_INFO("Error reported capturing image");
         }
-        ++m_frameCounter;
 
-        if (m_rawImageMode && !m_rawImageModeWarningDone)
+        // Frames the processing thread did not analyse are dropped if they
+        // are too old, so guiding does not act on stale data. When stopping
+        // the frame is still needed to stop guiding.
+        bool dropped = event.GetExtraLong() != 0 ||
+            (!pGuider->IsAnalyzedFrame(pNewFrame) && IsFrameStale(pNewFrame));
+
+        if (dropped && m_continueCapturing)
         {
-            WarnRawImageMode();
-            m_rawImageModeWarningDone = true;
+            NotifyStaleFrameDropped(pNewFrame);
+            delete pNewFrame;
         }
+        else
+        {
+            ++m_frameCounter;
+
+            if (m_rawImageMode && !m_rawImageModeWarningDone)
+            {
+                WarnRawImageMode();
+                m_rawImageModeWarningDone = true;
+            }
 
-        pGuider->UpdateGuideState(pNewFrame, !m_continueCapturing);
-        pNewFrame = NULL; // the guider owns it now
+            pGuider->UpdateGuideState(pNewFrame, !m_continueCapturing);
+            pNewFrame = NULL; // the guider owns it now
 
-        PhdController::UpdateControllerState();
+            PhdController::UpdateControllerState();
+        }
+
+        Debug.AddLine(wxString::Format("OnExposeCompete: CaptureActive=%d m_continueCapturing=%d exposurePending=%d",
+            CaptureActive, m_continueCapturing, m_exposurePending));
 
-        Debug.AddLine(wxString::Format("OnExposeCompete: CaptureActive=%d m_continueCapturing=%d",
-            CaptureActive, m_continueCapturing));
+        if (!m_continueCapturing && m_exposurePending)
+        {
+            Debug.AddLine("Stopping, waiting for the pipelined exposure to complete");
+            return;
+        }
 
         CaptureActive = m_continueCapturing;
 
         if (CaptureActive)
         {
-            ScheduleExposure();
+            if (!m_exposurePending)
+            {
+                ScheduleExposure();
+            }
+            if (!m_pipelinedExposurePending && CanPipelineExposures())
+            {
+                SchedulePipelinedExposure();
+            }
         }
         else
         {
@@ -57,3 +57,13 @@ bool OnboardST4::ST4PulseGuideScope(int direction, int duration)
     assert(false);
     return true;
 }
+
+bool OnboardST4::ST4CanPulseBothAxes(void)
+{
+    return false;
+}
+
+bool OnboardST4::ST4PulseGuideScopeBothAxes(int raDirection, int raDuration, int decDirection, int decDuration)
+{
+    return ST4PulseGuideScope(raDirection, raDuration) || ST4PulseGuideScope(decDirection, decDuration);
+}
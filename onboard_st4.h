@@ -43,6 +43,8 @@ public:
     virtual bool    ST4HostConnected(void);
     virtual bool    ST4HasNonGuiMove(void);
     virtual bool    ST4PulseGuideScope(int direction, int duration);
+    virtual bool    ST4CanPulseBothAxes(void);
+    virtual bool    ST4PulseGuideScopeBothAxes(int raDirection, int raDuration, int decDirection, int decDuration);
 };
 
 #endif //ONBOARD_ST4_H_INCLUDED
@@ -36,6 +36,7 @@
 
 #include <wx/cmdline.h>
 #include <wx/snglinst.h>
+#include <wx/stopwatch.h>
 
 #ifdef  __LINUX__
     #include <X11/Xlib.h>
@@ -55,6 +56,7 @@ GuideCamera *pCamera = NULL;
 
 DebugLog Debug;
 GuidingLog GuideLog;
+GuideCycleStats CycleStats;
 
 int XWinSize = 640;
 int YWinSize = 512;
@@ -63,6 +65,8 @@ static const wxCmdLineEntryDesc cmdLineDesc[] =
 {
     { wxCMD_LINE_OPTION, "i", "instanceNumber", "sets the PHD2 instance number (default = 1)", wxCMD_LINE_VAL_NUMBER, wxCMD_LINE_PARAM_OPTIONAL},
     { wxCMD_LINE_SWITCH, "R", "Reset", "Reset all PHD2 settings to default values"},
+    { wxCMD_LINE_OPTION, "B", "benchmark", "run the centroid benchmark, write the results to the given file and exit", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL},
+    { wxCMD_LINE_OPTION, NULL, "benchmark-baseline", "with --benchmark, exit with an error if the results are worse than in the given earlier report", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL},
     { wxCMD_LINE_NONE }
 };
 
@@ -87,11 +91,31 @@ static void DisableOSXAppNap(void)
 #endif
 }
 
+// Resident set size of the process in kB, for comparing builds; -1 if it
+// cannot be found on this platform
+static long ResidentMemoryKb(void)
+{
+#ifdef __LINUX__
+    wxFFile status("/proc/self/status", "r");
+    wxString text;
+    if (status.IsOpened() && status.ReadAll(&text))
+    {
+        int pos = text.Find("VmRSS:");
+        long kb;
+        if (pos != wxNOT_FOUND && text.Mid(pos + 6).Trim(false).BeforeFirst(' ').ToLong(&kb))
+            return kb;
+    }
+#endif
+    return -1;
+}
+
 // ------------------------  Phd App stuff -----------------------------
 PhdApp::PhdApp(void)
 {
     m_resetConfig = false;
     m_instanceNumber = 1;
+    m_benchmarkRan = false;
+    m_benchmarkFailed = false;
 #ifdef  __LINUX__
     XInitThreads();
 #endif // __LINUX__
@@ -99,6 +123,8 @@ PhdApp::PhdApp(void)
 
 bool PhdApp::OnInit()
 {
+    wxStopWatch startup;
+
     if (!wxApp::OnInit())
     {
         return false;
@@ -167,6 +193,14 @@ bool PhdApp::OnInit()
 
     PhdController::OnAppInit();
 
+    if (!m_benchmarkFile.IsEmpty())
+    {
+        // no main window; OnRun returns the result as the exit code
+        m_benchmarkRan = true;
+        m_benchmarkFailed = RunCentroidBenchmark(m_benchmarkFile, m_benchmarkBaseline);
+        return true;
+    }
+
     wxImage::AddHandler(new wxJPEGHandler);
     wxImage::AddHandler(new wxPNGHandler);
 
@@ -179,9 +213,21 @@ bool PhdApp::OnInit()
         pFrame->pGearDialog->ShowProfileWizard();
     }
 
+    Debug.AddLine("Startup took %ld ms, resident memory %ld kB", startup.Time(), ResidentMemoryKb());
+
     return true;
 }
 
+int PhdApp::OnRun(void)
+{
+    if (m_benchmarkRan)
+    {
+        return m_benchmarkFailed ? 1 : 0;
+    }
+
+    return wxApp::OnRun();
+}
+
 int PhdApp::OnExit(void)
 {
     assert(pMount == NULL);
@@ -213,6 +259,9 @@ bool PhdApp::OnCmdLineParsed(wxCmdLineParser & parser)
 
     m_resetConfig = parser.Found("R");
 
+    (void)parser.Found("B", &m_benchmarkFile);
+    (void)parser.Found("benchmark-baseline", &m_benchmarkBaseline);
+
     return bReturn;
 }
 
@@ -63,6 +63,7 @@
 #include <wx/thread.h>
 #include <wx/utils.h>
 
+#include <deque>
 #include <map>
 #include <math.h>
 #include <stdarg.h>
@@ -149,8 +150,13 @@ WX_DEFINE_ARRAY_DOUBLE(double, ArrayOfDbl);
 #include "optionsbutton.h"
 #include "usImage.h"
 #include "point.h"
+#include "psf_fit.h"
 #include "star.h"
+#include "star_catalog.h"
+#include "centroid_benchmark.h"
 #include "circbuf.h"
+#include "latency_stats.h"
+#include "ui_refresh.h"
 #include "guidinglog.h"
 #include "graph.h"
 #include "statswindow.h"
@@ -176,7 +182,11 @@ WX_DEFINE_ARRAY_DOUBLE(double, ArrayOfDbl);
 #include "myframe.h"
 #include "debuglog.h"
 #include "worker_thread.h"
+#include "processing_thread.h"
 #include "event_server.h"
+#include "guide_step_bus.h"
+#include "flight_recorder.h"
+#include "image_writer.h"
 #include "confirm_dialog.h"
 #include "phdcontrol.h"
 #include "runinbg.h"
@@ -199,6 +209,10 @@ class PhdApp : public wxApp
     long m_instanceNumber;
     bool m_resetConfig;
     wxString m_localeDir;
+    wxString m_benchmarkFile;
+    wxString m_benchmarkBaseline;
+    bool m_benchmarkRan;
+    bool m_benchmarkFailed;
 
 protected:
 
@@ -208,6 +222,7 @@ public:
 
     PhdApp(void);
     bool OnInit(void);
+    int OnRun(void);
     int OnExit(void);
     void OnInitCmdLine(wxCmdLineParser& parser);
     bool OnCmdLineParsed(wxCmdLineParser & parser);
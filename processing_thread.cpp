@@ -0,0 +1,134 @@
+/*
+ *  processing_thread.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2016 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "phd.h"
+
+ProcessingThread::ProcessingThread(MyFrame *pFrame)
+    : wxThread(wxTHREAD_JOINABLE),
+      m_pFrame(pFrame),
+      m_wakeup(m_lock),
+      m_terminate(false)
+{
+    Debug.AddLine("ProcessingThread constructor called");
+}
+
+ProcessingThread::~ProcessingThread(void)
+{
+    Debug.AddLine("ProcessingThread destructor called");
+}
+
+// called on the primary worker thread when a capture completes
+void ProcessingThread::EnqueueFrame(usImage *pImage, bool bError)
+{
+    PROCESSING_REQUEST request;
+    request.pImage = pImage;
+    request.error = bError;
+
+    wxMutexLocker lock(m_lock);
+
+    // latest wins: frames still waiting are superseded by this one. Failed
+    // captures are kept so the main thread sees the error.
+    std::deque<PROCESSING_REQUEST>::iterator it = m_queue.begin();
+    while (it != m_queue.end())
+    {
+        if (it->error)
+        {
+            ++it;
+            continue;
+        }
+        Debug.AddLine("ProcessingThread: frame superseded by a newer frame");
+        SendExposeComplete(it->pImage, false, true);
+        it = m_queue.erase(it);
+    }
+
+    m_queue.push_back(request);
+    m_wakeup.Signal();
+}
+
+void ProcessingThread::EnqueueTerminateRequest(void)
+{
+    wxMutexLocker lock(m_lock);
+    m_terminate = true;
+    m_wakeup.Signal();
+}
+
+void ProcessingThread::SendExposeComplete(usImage *pImage, bool bError, bool dropped)
+{
+    wxThreadEvent *event = new wxThreadEvent(wxEVT_THREAD, MYFRAME_WORKER_THREAD_EXPOSE_COMPLETE);
+    event->SetPayload<usImage *>(pImage);
+    event->SetInt(bError);
+    event->SetExtraLong(dropped);
+    wxQueueEvent(m_pFrame, event);
+}
+
+wxThread::ExitCode ProcessingThread::Entry()
+{
+    Debug.AddLine("ProcessingThread::Entry() begins");
+
+    while (true)
+    {
+        PROCESSING_REQUEST request;
+
+        {
+            wxMutexLocker lock(m_lock);
+
+            while (m_queue.empty() && !m_terminate)
+                m_wakeup.Wait();
+
+            // frames already queued are analysed before the thread exits
+            if (m_queue.empty())
+                break;
+
+            request = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        if (!request.error && m_pFrame->IsFrameStale(request.pImage))
+        {
+            Debug.AddLine("ProcessingThread: frame is too old, not analysed");
+            SendExposeComplete(request.pImage, false, true);
+            continue;
+        }
+
+        if (!request.error && m_pFrame->pGuider)
+        {
+            m_pFrame->pGuider->AnalyzeFrame(request.pImage);
+        }
+
+        SendExposeComplete(request.pImage, request.error, false);
+    }
+
+    Debug.AddLine("ProcessingThread::Entry() ends");
+
+    return (wxThread::ExitCode) 0;
+}
@@ -0,0 +1,79 @@
+/*
+ *  processing_thread.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2016 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PROCESSING_THREAD_H_INCLUDED
+#define PROCESSING_THREAD_H_INCLUDED
+
+class MyFrame;
+
+/*
+ * The processing thread sits between the primary worker thread and the main
+ * thread. Each captured frame is passed to it, and it runs the image analysis
+ * (star find, mass check, distance update) via Guider::AnalyzeFrame before
+ * the expose complete event is queued to the frame. The main thread runs the
+ * guider state machine on the result and schedules the guide correction, so
+ * the guider state and the mount request count are only changed there.
+ *
+ * Frames are never queued behind each other: a new frame replaces any frame
+ * still waiting to be analysed ("latest wins"), and a frame older than the
+ * configured maximum frame age is not analysed at all. Dropped frames are
+ * still passed to the main thread, flagged as dropped, so the exposure
+ * bookkeeping sees every frame.
+ */
+class ProcessingThread : public wxThread
+{
+    struct PROCESSING_REQUEST
+    {
+        usImage *pImage;
+        bool error;         // the capture failed
+    };
+
+    MyFrame *m_pFrame;
+    wxMutex m_lock;
+    wxCondition m_wakeup;
+    std::deque<PROCESSING_REQUEST> m_queue;
+    bool m_terminate;
+
+public:
+    ProcessingThread(MyFrame *pFrame);
+    ~ProcessingThread(void);
+
+    void EnqueueFrame(usImage *pImage, bool bError);
+    void EnqueueTerminateRequest(void);
+
+private:
+    wxThread::ExitCode Entry();
+    void SendExposeComplete(usImage *pImage, bool bError, bool dropped);
+};
+
+#endif /* PROCESSING_THREAD_H_INCLUDED */
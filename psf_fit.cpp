@@ -0,0 +1,308 @@
+/*
+ *  psf_fit.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2016 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "phd.h"
+
+// The fit is a plain Levenberg-Marquardt on the five parameters of a circular
+// profile: background, amplitude, x, y and width. Nothing is allocated; the
+// pixels are read directly from the image on each pass and the normal
+// equations are small enough to live on the stack. The Gaussian is separable,
+// so its exponentials are computed once per row and column rather than once
+// per pixel. The Moffat beta is fixed so that u^-beta reduces to a square
+// root, which keeps both models to a few multiplies per pixel.
+
+enum
+{
+    P_BKG,
+    P_AMP,
+    P_X,
+    P_Y,
+    P_WIDTH,
+    NPARAM
+};
+
+enum
+{
+    MAX_BOX = 128,
+    MIN_BOX = 5,
+    MAX_ITERATIONS = 25,
+};
+
+static const double MoffatBeta = 2.5;
+static const double MinWidth = 0.3;         // narrower than this is a hot pixel, not a star
+static const double PositionTolerance = 1e-3;
+static const double MaxLambda = 1e6;
+
+struct NormalEquations
+{
+    double a[NPARAM][NPARAM];   // J^T J
+    double b[NPARAM];           // J^T r
+    double chi2;
+};
+
+inline static double MoffatPow(double u)
+{
+    // u^-2.5 for MoffatBeta = 2.5
+    return 1.0 / (u * u * sqrt(u));
+}
+
+// Accumulate the normal equations for one row of the box. The sums are kept
+// in locals so the compiler can keep them in registers across the row.
+template <PsfModel MODEL>
+static void AccumulateRow(const unsigned short *px, int width, const double *dxs, const double *ex,
+                          double dy, double ey, const double *p, NormalEquations *ne)
+{
+    double const bkg = p[P_BKG];
+    double const amp = p[P_AMP];
+    double const inv_w2 = 1.0 / (p[P_WIDTH] * p[P_WIDTH]);
+    double const inv_w = 1.0 / p[P_WIDTH];
+
+    double a11 = 0, a12 = 0, a13 = 0, a14 = 0, a15 = 0;
+    double a22 = 0, a23 = 0, a24 = 0, a25 = 0;
+    double a33 = 0, a34 = 0, a35 = 0;
+    double a44 = 0, a45 = 0;
+    double a55 = 0;
+    double b1 = 0, b2 = 0, b3 = 0, b4 = 0, b5 = 0;
+    double chi2 = 0;
+
+    for (int i = 0; i < width; i++)
+    {
+        double const dx = dxs[i];
+        double const r2 = dx * dx + dy * dy;
+
+        // g is the unit-amplitude profile and k its derivative with
+        // respect to the center, divided by the distance from the center
+        double g, k;
+        if (MODEL == PSF_GAUSSIAN)
+        {
+            g = ex[i] * ey;
+            k = g * inv_w2;
+        }
+        else
+        {
+            double u = 1.0 + r2 * inv_w2;
+            g = MoffatPow(u);
+            k = 2.0 * MoffatBeta * g / u * inv_w2;
+        }
+
+        double const ak = amp * k;
+        double const j2 = g;
+        double const j3 = ak * dx;
+        double const j4 = ak * dy;
+        double const j5 = ak * r2 * inv_w;
+
+        double const r = (double) px[i] - (bkg + amp * g);
+        chi2 += r * r;
+
+        a11 += 1.0; a12 += j2;      a13 += j3;      a14 += j4;      a15 += j5;
+        a22 += j2 * j2; a23 += j2 * j3; a24 += j2 * j4; a25 += j2 * j5;
+        a33 += j3 * j3; a34 += j3 * j4; a35 += j3 * j5;
+        a44 += j4 * j4; a45 += j4 * j5;
+        a55 += j5 * j5;
+        b1 += r; b2 += j2 * r; b3 += j3 * r; b4 += j4 * r; b5 += j5 * r;
+    }
+
+    ne->a[0][0] += a11; ne->a[0][1] += a12; ne->a[0][2] += a13; ne->a[0][3] += a14; ne->a[0][4] += a15;
+    ne->a[1][1] += a22; ne->a[1][2] += a23; ne->a[1][3] += a24; ne->a[1][4] += a25;
+    ne->a[2][2] += a33; ne->a[2][3] += a34; ne->a[2][4] += a35;
+    ne->a[3][3] += a44; ne->a[3][4] += a45;
+    ne->a[4][4] += a55;
+    ne->b[0] += b1; ne->b[1] += b2; ne->b[2] += b3; ne->b[3] += b4; ne->b[4] += b5;
+    ne->chi2 += chi2;
+}
+
+static void Accumulate(const usImage& img, const wxRect& box, PsfModel model, const double *p, NormalEquations *ne)
+{
+    memset(ne, 0, sizeof(*ne));
+
+    int const rowsize = img.Size.GetWidth();
+    double const inv_w2 = 1.0 / (p[P_WIDTH] * p[P_WIDTH]);
+
+    double dxs[MAX_BOX];
+    double ex[MAX_BOX];
+
+    for (int i = 0; i < box.width; i++)
+    {
+        double dx = (double)(box.x + i) - p[P_X];
+        dxs[i] = dx;
+        ex[i] = model == PSF_GAUSSIAN ? exp(-0.5 * dx * dx * inv_w2) : 0.0;
+    }
+
+    for (int y = box.y; y < box.y + box.height; y++)
+    {
+        double const dy = (double) y - p[P_Y];
+        const unsigned short *px = img.ImageData + rowsize * y + box.x;
+
+        if (model == PSF_GAUSSIAN)
+            AccumulateRow<PSF_GAUSSIAN>(px, box.width, dxs, ex, dy, exp(-0.5 * dy * dy * inv_w2), p, ne);
+        else
+            AccumulateRow<PSF_MOFFAT>(px, box.width, dxs, ex, dy, 0.0, p, ne);
+    }
+
+    for (int m = 1; m < NPARAM; m++)
+        for (int n = 0; n < m; n++)
+            ne->a[m][n] = ne->a[n][m];
+}
+
+// solve (J^T J + lambda diag(J^T J)) dp = J^T r by Cholesky decomposition,
+// returns true if the system is singular
+static bool SolveStep(const NormalEquations& ne, double lambda, double *dp)
+{
+    double L[NPARAM][NPARAM];
+
+    for (int i = 0; i < NPARAM; i++)
+    {
+        for (int j = 0; j <= i; j++)
+        {
+            double sum = ne.a[i][j];
+            if (i == j)
+                sum += lambda * ne.a[i][i];
+            for (int k = 0; k < j; k++)
+                sum -= L[i][k] * L[j][k];
+            if (i == j)
+            {
+                if (sum <= 0.0)
+                    return true;
+                L[i][i] = sqrt(sum);
+            }
+            else
+                L[i][j] = sum / L[j][j];
+        }
+    }
+
+    double z[NPARAM];
+    for (int i = 0; i < NPARAM; i++)
+    {
+        double sum = ne.b[i];
+        for (int k = 0; k < i; k++)
+            sum -= L[i][k] * z[k];
+        z[i] = sum / L[i][i];
+    }
+    for (int i = NPARAM - 1; i >= 0; i--)
+    {
+        double sum = z[i];
+        for (int k = i + 1; k < NPARAM; k++)
+            sum -= L[k][i] * dp[k];
+        dp[i] = sum / L[i][i];
+    }
+
+    return false;
+}
+
+bool PsfFit(const usImage& img, const wxRect& box, PsfModel model, PsfFitResult *result)
+{
+    if (box.width > MAX_BOX || box.width < MIN_BOX || box.height < MIN_BOX)
+    {
+        Debug.AddLine("PsfFit: unsupported box size %dx%d", box.width, box.height);
+        return true;
+    }
+
+    double p[NPARAM];
+    p[P_BKG] = result->background;
+    p[P_AMP] = result->amplitude;
+    p[P_X] = result->x;
+    p[P_Y] = result->y;
+    p[P_WIDTH] = result->width;
+
+    NormalEquations cur, trial;
+    Accumulate(img, box, model, p, &cur);
+
+    double lambda = 1e-3;
+    bool converged = false;
+    unsigned int iter;
+
+    for (iter = 0; iter < MAX_ITERATIONS && !converged; iter++)
+    {
+        double dp[NPARAM];
+        if (SolveStep(cur, lambda, dp))
+            break;
+
+        double q[NPARAM];
+        for (int i = 0; i < NPARAM; i++)
+            q[i] = p[i] + dp[i];
+
+        bool better = false;
+        if (q[P_AMP] > 0.0 && q[P_WIDTH] >= MinWidth && q[P_WIDTH] <= box.width)
+        {
+            Accumulate(img, box, model, q, &trial);
+            better = trial.chi2 < cur.chi2;
+        }
+
+        if (better)
+        {
+            memcpy(p, q, sizeof(p));
+            cur = trial;
+            lambda = wxMax(lambda / 10.0, 1e-7);
+            converged = fabs(dp[P_X]) < PositionTolerance && fabs(dp[P_Y]) < PositionTolerance;
+        }
+        else
+        {
+            lambda *= 10.0;
+            // no step reduces chi^2 any more, we are at the minimum
+            if (lambda > MaxLambda)
+                converged = true;
+        }
+    }
+
+    result->background = p[P_BKG];
+    result->amplitude = p[P_AMP];
+    result->x = p[P_X];
+    result->y = p[P_Y];
+    result->width = p[P_WIDTH];
+    result->iterations = iter;
+
+    if (!converged)
+    {
+        Debug.AddLine("PsfFit: did not converge after %u iterations", iter);
+        return true;
+    }
+
+    if (result->x < box.GetLeft() || result->x > box.GetRight() ||
+        result->y < box.GetTop() || result->y > box.GetBottom() ||
+        result->width > 0.5 * wxMin(box.width, box.height))
+    {
+        Debug.AddLine("PsfFit: implausible fit x=%.2f y=%.2f width=%.2f", result->x, result->y, result->width);
+        return true;
+    }
+
+    return false;
+}
+
+double PsfWidthFromSigma(PsfModel model, double sigma)
+{
+    if (model == PSF_GAUSSIAN)
+        return sigma;
+
+    // match the FWHM: 2 sqrt(2 ln 2) sigma = 2 alpha sqrt(2^(1/beta) - 1)
+    return sigma * sqrt(2.0 * log(2.0)) / sqrt(pow(2.0, 1.0 / MoffatBeta) - 1.0);
+}
@@ -0,0 +1,61 @@
+/*
+ *  psf_fit.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2016 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PSF_FIT_H_INCLUDED
+#define PSF_FIT_H_INCLUDED
+
+enum PsfModel
+{
+    PSF_GAUSSIAN,
+    PSF_MOFFAT,     // fixed beta, see psf_fit.cpp
+};
+
+struct PsfFitResult
+{
+    double background;
+    double amplitude;
+    double x;
+    double y;
+    double width;           // Gaussian sigma or Moffat alpha, in pixels
+    unsigned int iterations;
+};
+
+// Least-squares fit of a circular PSF to the pixels of box. On entry result
+// holds the initial estimate, on return the fitted parameters. Returns true
+// on error (the fit did not converge to a plausible star).
+extern bool PsfFit(const usImage& img, const wxRect& box, PsfModel model, PsfFitResult *result);
+
+// PSF width parameter giving the same FWHM as a Gaussian of the given sigma
+extern double PsfWidthFromSigma(PsfModel model, double sigma);
+
+#endif /* PSF_FIT_H_INCLUDED */
@@ -531,91 +531,102 @@ static void AlertLimitReached(GuideAxis axis)
     }
 }
 
-Mount::MOVE_RESULT Scope::Move(GUIDE_DIRECTION direction, int duration, bool normalMove, MoveResultInfo *moveResult)
+// Enforce the guide mode and the maximum durations for normal moves
+int Scope::LimitGuideDuration(GUIDE_DIRECTION direction, int duration, bool normalMove, bool *limited)
 {
-    MOVE_RESULT result = MOVE_OK;
     bool limitReached = false;
 
-    try
+    switch (direction)
     {
-        Debug.AddLine("Move(%d, %d, %d)", direction, duration, normalMove);
-
-        if (!m_guidingEnabled)
-        {
-            throw THROW_INFO("Guiding disabled");
-        }
-
-        // Compute the actual guide durations
+        case NORTH:
+        case SOUTH:
 
-        switch (direction)
-        {
-            case NORTH:
-            case SOUTH:
+            // Enforce dec guiding mode and max dec duration for normal moves
+            if (normalMove)
+            {
+                if ((m_decGuideMode == DEC_NONE) ||
+                    (direction == SOUTH && m_decGuideMode == DEC_NORTH) ||
+                    (direction == NORTH && m_decGuideMode == DEC_SOUTH))
+                {
+                    duration = 0;
+                    Debug.AddLine("duration set to 0 by GuideMode");
+                }
 
-                // Enforce dec guiding mode and max dec duration for normal moves
-                if (normalMove)
+                if (duration > m_maxDecDuration)
                 {
-                    if ((m_decGuideMode == DEC_NONE) ||
-                        (direction == SOUTH && m_decGuideMode == DEC_NORTH) ||
-                        (direction == NORTH && m_decGuideMode == DEC_SOUTH))
-                    {
-                        duration = 0;
-                        Debug.AddLine("duration set to 0 by GuideMode");
-                    }
+                    duration = m_maxDecDuration;
+                    Debug.AddLine("duration set to %d by maxDecDuration", duration);
+                    limitReached = true;
+                }
 
-                    if (duration > m_maxDecDuration)
-                    {
-                        duration = m_maxDecDuration;
-                        Debug.AddLine("duration set to %d by maxDecDuration", duration);
-                        limitReached = true;
-                    }
+                if (limitReached && direction == m_decLimitReachedDirection)
+                {
+                    if (++m_decLimitReachedCount >= LIMIT_REACHED_WARN_COUNT)
+                        AlertLimitReached(GUIDE_DEC);
+                }
+                else
+                    m_decLimitReachedCount = 0;
 
-                    if (limitReached && direction == m_decLimitReachedDirection)
-                    {
-                        if (++m_decLimitReachedCount >= LIMIT_REACHED_WARN_COUNT)
-                            AlertLimitReached(GUIDE_DEC);
-                    }
-                    else
-                        m_decLimitReachedCount = 0;
+                if (limitReached)
+                    m_decLimitReachedDirection = direction;
+                else
+                    m_decLimitReachedDirection = NONE;
+            }
+            break;
+        case EAST:
+        case WEST:
 
-                    if (limitReached)
-                        m_decLimitReachedDirection = direction;
-                    else
-                        m_decLimitReachedDirection = NONE;
+            if (normalMove)
+            {
+                // enforce max RA duration for normal moves
+                if (duration > m_maxRaDuration)
+                {
+                    duration = m_maxRaDuration;
+                    Debug.AddLine("duration set to %d by maxRaDuration", duration);
+                    limitReached = true;
                 }
-                break;
-            case EAST:
-            case WEST:
 
-                if (normalMove)
+                if (limitReached && direction == m_raLimitReachedDirection)
                 {
-                    // enforce max RA duration for normal moves
-                    if (duration > m_maxRaDuration)
-                    {
-                        duration = m_maxRaDuration;
-                        Debug.AddLine("duration set to %d by maxRaDuration", duration);
-                        limitReached = true;
-                    }
+                    if (++m_raLimitReachedCount >= LIMIT_REACHED_WARN_COUNT)
+                        AlertLimitReached(GUIDE_RA);
+                }
+                else
+                    m_raLimitReachedCount = 0;
 
-                    if (limitReached && direction == m_raLimitReachedDirection)
-                    {
-                        if (++m_raLimitReachedCount >= LIMIT_REACHED_WARN_COUNT)
-                            AlertLimitReached(GUIDE_RA);
-                    }
-                    else
-                        m_raLimitReachedCount = 0;
+                if (limitReached)
+                    m_raLimitReachedDirection = direction;
+                else
+                    m_raLimitReachedDirection = NONE;
+            }
+            break;
 
-                    if (limitReached)
-                        m_raLimitReachedDirection = direction;
-                    else
-                        m_raLimitReachedDirection = NONE;
-                }
-                break;
+        case NONE:
+            break;
+    }
 
-            case NONE:
-                break;
+    *limited = limitReached;
+    return duration;
+}
+
+Mount::MOVE_RESULT Scope::Move(GUIDE_DIRECTION direction, int duration, bool normalMove, MoveResultInfo *moveResult)
+{
+    MOVE_RESULT result = MOVE_OK;
+    bool limitReached = false;
+
+    try
+    {
+        Debug.AddLine("Move(%d, %d, %d)", direction, duration, normalMove);
+
+        if (!m_guidingEnabled)
+        {
+            throw THROW_INFO("Guiding disabled");
         }
 
+        // Compute the actual guide durations
+
+        duration = LimitGuideDuration(direction, duration, normalMove, &limitReached);
+
         // Actually do the guide
         assert(duration >= 0);
         if (duration > 0)
@@ -646,6 +657,85 @@ Mount::MOVE_RESULT Scope::Move(GUIDE_DIRECTION direction, int duration, bool nor
     return result;
 }
 
+Mount::MOVE_RESULT Scope::MoveAxes(GUIDE_DIRECTION xDirection, int xAmount, GUIDE_DIRECTION yDirection, int yAmount,
+                                   bool normalMove, MoveResultInfo *xMoveResult, MoveResultInfo *yMoveResult)
+{
+    if (!CanGuideAxesConcurrently())
+    {
+        return Mount::MoveAxes(xDirection, xAmount, yDirection, yAmount, normalMove, xMoveResult, yMoveResult);
+    }
+
+    MOVE_RESULT result = MOVE_OK;
+    bool xLimited = false;
+    bool yLimited = false;
+
+    try
+    {
+        Debug.AddLine("MoveAxes(%d, %d, %d, %d, %d)", xDirection, xAmount, yDirection, yAmount, normalMove);
+
+        if (!m_guidingEnabled)
+        {
+            throw THROW_INFO("Guiding disabled");
+        }
+
+        xAmount = LimitGuideDuration(xDirection, xAmount, normalMove, &xLimited);
+        yAmount = LimitGuideDuration(yDirection, yAmount, normalMove, &yLimited);
+
+        assert(xAmount >= 0 && yAmount >= 0);
+        if (xAmount > 0 && yAmount > 0)
+        {
+            result = GuideAxes(xDirection, xAmount, yDirection, yAmount);
+            if (result != MOVE_OK)
+            {
+                throw ERROR_INFO("concurrent guide failed");
+            }
+            Debug.AddLine("Concurrent guide pulses RA %d ms Dec %d ms, saved %d ms", xAmount, yAmount, wxMin(xAmount, yAmount));
+        }
+        else if (xAmount > 0)
+        {
+            result = Guide(xDirection, xAmount);
+        }
+        else if (yAmount > 0)
+        {
+            result = Guide(yDirection, yAmount);
+        }
+
+        if (result != MOVE_OK)
+        {
+            throw ERROR_INFO("guide failed");
+        }
+    }
+    catch (const wxString& Msg)
+    {
+        POSSIBLY_UNUSED(Msg);
+        if (result == MOVE_OK)
+            result = MOVE_ERROR;
+        xAmount = yAmount = 0;
+    }
+
+    Debug.AddLine(wxString::Format("MoveAxes returns status %d, amounts %d, %d", result, xAmount, yAmount));
+
+    xMoveResult->amountMoved = xAmount;
+    xMoveResult->limited = xLimited;
+    yMoveResult->amountMoved = yAmount;
+    yMoveResult->limited = yLimited;
+
+    return result;
+}
+
+bool Scope::CanGuideAxesConcurrently(void)
+{
+    return false;
+}
+
+Mount::MOVE_RESULT Scope::GuideAxes(GUIDE_DIRECTION raDirection, int raDurationMs, GUIDE_DIRECTION decDirection, int decDurationMs)
+{
+    MOVE_RESULT result = Guide(raDirection, raDurationMs);
+    if (result == MOVE_OK)
+        result = Guide(decDirection, decDurationMs);
+    return result;
+}
+
 static wxString CalibrationWarningKey(Calibration_Issues etype)
 {
     wxString qual;
@@ -186,10 +186,20 @@ public:
     virtual void EndDecDrift(void);
     virtual bool IsDecDrifting(void) const;
 
+    virtual MOVE_RESULT MoveAxes(GUIDE_DIRECTION xDirection, int xAmount, GUIDE_DIRECTION yDirection, int yAmount,
+                                 bool normalMove, MoveResultInfo *xMoveResult, MoveResultInfo *yMoveResult);
+
+    // mounts that can run an RA and a Dec guide pulse at the same time
+    // override these; the total move time is then the longer of the two
+    // pulses instead of their sum
+    virtual bool CanGuideAxesConcurrently(void);
+    virtual MOVE_RESULT GuideAxes(GUIDE_DIRECTION raDirection, int raDurationMs, GUIDE_DIRECTION decDirection, int decDurationMs);
+
 private:
     // functions with an implemenation in Scope that cannot be over-ridden
     // by a subclass
     MOVE_RESULT Move(GUIDE_DIRECTION direction, int durationMs, bool normalMove, MoveResultInfo *moveResultInfo);
+    int LimitGuideDuration(GUIDE_DIRECTION direction, int durationMs, bool normalMove, bool *limited);
     MOVE_RESULT CalibrationMove(GUIDE_DIRECTION direction, int duration);
     int CalibrationMoveSize(void);
     int CalibrationTotDistance(void);
@@ -414,6 +414,24 @@ Mount::MOVE_RESULT ScopeINDI::Guide(GUIDE_DIRECTION direction, int duration)
   else return MOVE_ERROR;
 }
 
+// The RA and Dec pulses are separate properties, so both can be sent before
+// waiting for the longer one to finish
+Mount::MOVE_RESULT ScopeINDI::GuideAxes(GUIDE_DIRECTION raDirection, int raDuration, GUIDE_DIRECTION decDirection, int decDuration)
+{
+    if (!pulseGuideNS_prop || !pulseGuideEW_prop)
+        return MOVE_ERROR;
+
+    pulseE_prop->value = raDirection == EAST ? raDuration : 0;
+    pulseW_prop->value = raDirection == WEST ? raDuration : 0;
+    pulseN_prop->value = decDirection == NORTH ? decDuration : 0;
+    pulseS_prop->value = decDirection == SOUTH ? decDuration : 0;
+    sendNewNumber(pulseGuideEW_prop);
+    sendNewNumber(pulseGuideNS_prop);
+
+    wxMilliSleep(wxMax(raDuration, decDuration));
+    return MOVE_OK;
+}
+
 double ScopeINDI::GetGuidingDeclination(void)
 {
     double dec;
@@ -99,6 +99,8 @@ public:
     void     SetupDialog();
 
     MOVE_RESULT Guide(GUIDE_DIRECTION direction, int duration);
+    bool        CanGuideAxesConcurrently(void) { return CanPulseGuide(); }
+    MOVE_RESULT GuideAxes(GUIDE_DIRECTION raDirection, int raDuration, GUIDE_DIRECTION decDirection, int decDuration);
 
     bool   CanPulseGuide() { return (pulseGuideNS_prop && pulseGuideEW_prop);}
     bool   CanReportPosition(void) { return (coord_prop); }
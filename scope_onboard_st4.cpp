@@ -150,6 +150,47 @@ Mount::MOVE_RESULT ScopeOnboardST4::Guide(GUIDE_DIRECTION direction, int duratio
     return result;
 }
 
+bool ScopeOnboardST4::CanGuideAxesConcurrently(void)
+{
+    return IsConnected() && m_pOnboardHost && m_pOnboardHost->ST4HostConnected() &&
+        m_pOnboardHost->ST4CanPulseBothAxes();
+}
+
+Mount::MOVE_RESULT ScopeOnboardST4::GuideAxes(GUIDE_DIRECTION raDirection, int raDuration, GUIDE_DIRECTION decDirection, int decDuration)
+{
+    MOVE_RESULT result = MOVE_OK;
+
+    try
+    {
+        if (!IsConnected())
+        {
+            throw ERROR_INFO("Attempt to Guide On Camera mount when not connected");
+        }
+
+        if (!m_pOnboardHost)
+        {
+            throw ERROR_INFO("Attempt to Guide OnboardST4 mount when m_pOnboardHost == NULL");
+        }
+
+        if (!m_pOnboardHost->ST4HostConnected())
+        {
+            throw ERROR_INFO("Attempt to Guide On Camera mount when camera is not connected");
+        }
+
+        if (m_pOnboardHost->ST4PulseGuideScopeBothAxes(raDirection, raDuration, decDirection, decDuration))
+        {
+            result = MOVE_ERROR;
+        }
+    }
+    catch (wxString Msg)
+    {
+        POSSIBLY_UNUSED(Msg);
+        result = MOVE_ERROR;
+    }
+
+    return result;
+}
+
 bool ScopeOnboardST4::HasNonGuiMove(void)
 {
     bool bReturn = false;
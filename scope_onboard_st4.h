@@ -52,6 +52,9 @@ public:
     virtual bool HasNonGuiMove(void);
 
     virtual MOVE_RESULT Guide(GUIDE_DIRECTION direction, int duration);
+
+    virtual bool CanGuideAxesConcurrently(void);
+    virtual MOVE_RESULT GuideAxes(GUIDE_DIRECTION raDirection, int raDuration, GUIDE_DIRECTION decDirection, int decDuration);
 };
 
 #endif // SCOPE_ONBOARD_ST4_H_INCLUDED
@@ -37,6 +37,8 @@
 
 #include "phd.h"
 
+#include <algorithm>
+
 Star::Star(void)
 {
     Invalidate();
@@ -79,6 +81,18 @@ void Star::SetError(FindResult error)
     m_lastFindResult = error;
 }
 
+static PsfModel s_psfModel = PSF_GAUSSIAN;
+
+void Star::SetPsfModel(PsfModel model)
+{
+    s_psfModel = model;
+}
+
+PsfModel Star::GetPsfModel(void)
+{
+    return s_psfModel;
+}
+
 bool Star::Find(const usImage *pImg, int searchRegion, int base_x, int base_y, FindMode mode)
 {
     FindResult Result = STAR_OK;
@@ -243,6 +257,35 @@ bool Star::Find(const usImage *pImg, int searchRegion, int base_x, int base_y, F
                 if ((unsigned int)(max - nearmax2) * 65535U < 32U * (unsigned int) max)
                     Result = STAR_SATURATED;
             }
+
+            // refine the centroid with a PSF fit over the search box, starting
+            // from the centroid. Saturated stars have flat tops that no PSF
+            // model fits, so they keep the centroid.
+            if (mode == FIND_PSF_FIT && Result == STAR_OK)
+            {
+                PsfFitResult fit;
+                fit.background = localmean;
+                fit.amplitude = wxMax((double) max + localmin - localmean, 1.0);
+                fit.x = newX;
+                fit.y = newY;
+                double sigma = sqrt(mass / (2.0 * M_PI * fit.amplitude));
+                fit.width = PsfWidthFromSigma(s_psfModel, wxMin(wxMax(sigma, 0.7), searchRegion / 2.0));
+
+                wxRect box(start_x, start_y, end_x - start_x + 1, end_y - start_y + 1);
+
+                if (!PsfFit(*pImg, box, s_psfModel, &fit) &&
+                    fabs(fit.x - newX) <= hft_range && fabs(fit.y - newY) <= hft_range)
+                {
+                    Debug.AddLine("Star::Find PSF fit (%.2f,%.2f) -> (%.2f,%.2f) width=%.2f iter=%u",
+                        newX, newY, fit.x, fit.y, fit.width, fit.iterations);
+                    newX = fit.x;
+                    newY = fit.y;
+                }
+                else
+                {
+                    Debug.AddLine("Star::Find PSF fit failed, using centroid");
+                }
+            }
         }
     }
     catch (wxString Msg)
@@ -278,94 +321,89 @@ bool Star::Find(const usImage *pImg, int searchRegion, FindMode mode)
     return Find(pImg, searchRegion, X, Y, mode);
 }
 
-struct FloatImg
+// AutoFind works on horizontal bands of the image so that the scratch memory
+// it needs is proportional to the frame width rather than the frame area.
+// Each band is median filtered and convolved together with enough rows of
+// overlap from its neighbors that the results are identical to filtering and
+// convolving the entire frame at once.
+
+enum
 {
-    float *px;
-    wxSize Size;
-    int NPixels;
-
-    FloatImg() : px(0) { }
-    FloatImg(const wxSize& size) : px(0) { Init(size); }
-    FloatImg(const usImage& img) : px(0) {
-        Init(img.Size);
-        for (int i = 0; i < NPixels; i++)
-            px[i] = (float) img.ImageData[i];
-    }
-    ~FloatImg() { delete[] px; }
-    void Init(const wxSize& sz) { delete[] px;  Size = sz; NPixels = Size.GetWidth() * Size.GetHeight(); px = new float[NPixels]; }
-    void Swap(FloatImg& other) { std::swap(px, other.px); std::swap(Size, other.Size); std::swap(NPixels, other.NPixels); }
+    CONV_RADIUS = 4,    // half-width of the PSF convolution kernel
+    MAX_SRCH = 4,       // local maximum search radius
+    LOCAL_RADIUS = 7,   // half-width of the local background window
+    BAND_ROWS = 64,     // rows of output per band
 };
 
-static void GetStats(double *mean, double *stdev, const FloatImg& img, const wxRect& win)
+struct RunningStats
 {
-    // Determine the mean and standard deviation
-    double sum = 0.0;
-    double a = 0.0;
-    double q = 0.0;
-    double k = 1.0;
-    double km1 = 0.0;
-
-    const int width = img.Size.GetWidth();
-    const float *p0 = &img.px[win.GetTop() * width + win.GetLeft()];
-    for (int y = 0; y < win.GetHeight(); y++)
+    double sum;
+    double a;
+    double q;
+    double k;
+    double km1;
+
+    RunningStats() : sum(0.0), a(0.0), q(0.0), k(1.0), km1(0.0) { }
+
+    void Add(double x)
     {
-        const float *end = p0 + win.GetWidth();
-        for (const float *p = p0; p < end; p++)
-        {
-            double const x = (double) *p;
-            sum += x;
-            double const a0 = a;
-            a += (x - a) / k;
-            q += (x - a0) * (x - a);
-            km1 = k;
-            k += 1.0;
-        }
-        p0 += width;
+        sum += x;
+        double const a0 = a;
+        a += (x - a) / k;
+        q += (x - a0) * (x - a);
+        km1 = k;
+        k += 1.0;
     }
 
-    *mean = sum / km1;
-    *stdev = sqrt(q / km1);
-}
-
-// un-comment to save the intermediate autofind image
-//#define SAVE_AUTOFIND_IMG
+    double Mean() const { return sum / km1; }
+    double Stdev() const { return sqrt(q / km1); }
+};
 
-static void SaveImage(const FloatImg& img, const char *name)
+// convolved image data for a range of rows [Y0, Y0 + Rows) of the full frame
+struct ConvBand
 {
-#ifdef SAVE_AUTOFIND_IMG
-    float maxv = img.px[0];
-    float minv = img.px[0];
-
-    for (int i = 1; i < img.NPixels; i++)
-    {
-        if (img.px[i] > maxv)
-            maxv = img.px[i];
-        if (img.px[i] < minv)
-            minv = img.px[i];
-    }
+    float *px;
+    int Width;
+    int Y0;
+    int Rows;
+
+    ConvBand(int width, int maxRows) : px(new float[width * maxRows]), Width(width), Y0(0), Rows(0) { }
+    ~ConvBand() { delete[] px; }
+    const float *Row(int y) const { return px + (y - Y0) * Width; }
+    float *Row(int y) { return px + (y - Y0) * Width; }
+};
 
-    usImage tmp;
-    tmp.Init(img.Size);
-    for (int i = 0; i < tmp.NPixels; i++)
+static void AccumStats(RunningStats& stats, const ConvBand& band, const wxRect& win)
+{
+    const float *p0 = band.Row(win.GetTop()) + win.GetLeft();
+    for (int y = 0; y < win.GetHeight(); y++)
     {
-        tmp.ImageData[i] = (unsigned short)(((double) img.px[i] - minv) * 65535.0 / (maxv - minv));
+        const float *end = p0 + win.GetWidth();
+        for (const float *p = p0; p < end; p++)
+            stats.Add((double) *p);
+        p0 += band.Width;
     }
-
-    tmp.Save(wxFileName(Debug.GetLogDir(), name).GetFullPath());
-#endif // SAVE_AUTOFIND_IMG
 }
 
-static void psf_conv(FloatImg& dst, const FloatImg& src)
+static void GetStats(double *mean, double *stdev, const ConvBand& band, const wxRect& win)
 {
-    dst.Init(src.Size);
+    // Determine the mean and standard deviation
+    RunningStats stats;
+    AccumStats(stats, band, win);
+    *mean = stats.Mean();
+    *stdev = stats.Stdev();
+}
 
+// Convolve rows [dst.Y0, dst.Y0 + dst.Rows) with the PSF. src holds median-filtered
+// image rows starting at row srcY0 and must include CONV_RADIUS rows above and
+// below the destination rows. Only columns [CONV_RADIUS, width - CONV_RADIUS) are
+// computed.
+static void psf_conv(ConvBand& dst, const unsigned short *src, int srcY0)
+{
     //                       A      B1     B2    C1     C2    C3     D1     D2     D3
     const double PSF[] = { 0.906, 0.584, 0.365, .117, .049, -0.05, -.064, -.074, -.094 };
 
-    int const width = src.Size.GetWidth();
-    int const height = src.Size.GetHeight();
-
-    memset(dst.px, 0, src.NPixels * sizeof(float));
+    int const width = dst.Width;
 
     /* PSF Grid is:
     D3 D3 D3 D3 D3 D3 D3 D3 D3
@@ -384,15 +422,16 @@ static void psf_conv(FloatImg& dst, const FloatImg& src)
     44 * D3
     */
 
-    int psf_size = 4;
-
-    for (int y = psf_size; y < height - psf_size; y++)
+    for (int y = dst.Y0; y < dst.Y0 + dst.Rows; y++)
     {
-        for (int x = psf_size; x < width - psf_size; x++)
+        const unsigned short *srow = src + width * (y - srcY0);
+        float *drow = dst.Row(y);
+
+        for (int x = CONV_RADIUS; x < width - CONV_RADIUS; x++)
         {
             float A, B1, B2, C1, C2, C3, D1, D2, D3;
 
-#define PX(dx, dy) *(src.px + width * (y + (dy)) + x + (dx))
+#define PX(dx, dy) (float) *(srow + width * (dy) + x + (dx))
             A =  PX(+0, +0);
             B1 = PX(+0, -1) + PX(+0, +1) + PX(+1, +0) + PX(-1, +0);
             B2 = PX(-1, -1) + PX(+1, -1) + PX(-1, +1) + PX(+1, +1);
@@ -404,58 +443,36 @@ static void psf_conv(FloatImg& dst, const FloatImg& src)
             D3 = PX(-4, -2) + PX(-3, -2) + PX(+3, -2) + PX(+4, -2) + PX(-4, -1) + PX(+4, -1) + PX(-4, +0) + PX(+4, +0) + PX(-4, +1) + PX(+4, +1) + PX(-4, +2) + PX(-3, +2) + PX(+3, +2) + PX(+4, +2);
 #undef PX
             int i;
-            const float *uptr;
+            const unsigned short *uptr;
 
-            uptr = src.px + width * (y - 4) + (x - 4);
+            uptr = srow - width * 4 + (x - 4);
             for (i = 0; i < 9; i++)
-                D3 += *uptr++;
+                D3 += (float) *uptr++;
 
-            uptr = src.px + width * (y - 3) + (x - 4);
+            uptr = srow - width * 3 + (x - 4);
             for (i = 0; i < 3; i++)
-                D3 += *uptr++;
+                D3 += (float) *uptr++;
             uptr += 3;
             for (i = 0; i < 3; i++)
-                D3 += *uptr++;
+                D3 += (float) *uptr++;
 
-            uptr = src.px + width * (y + 3) + (x - 4);
+            uptr = srow + width * 3 + (x - 4);
             for (i = 0; i < 3; i++)
-                D3 += *uptr++;
+                D3 += (float) *uptr++;
             uptr += 3;
             for (i = 0; i < 3; i++)
-                D3 += *uptr++;
+                D3 += (float) *uptr++;
 
-            uptr = src.px + width * (y + 4) + (x - 4);
+            uptr = srow + width * 4 + (x - 4);
             for (i = 0; i < 9; i++)
-                D3 += *uptr++;
+                D3 += (float) *uptr++;
 
             double mean = (A + B1 + B2 + C1 + C2 + C3 + D1 + D2 + D3) / 81.0;
             double PSF_fit = PSF[0] * (A - mean) + PSF[1] * (B1 - 4.0 * mean) + PSF[2] * (B2 - 4.0 * mean) +
                 PSF[3] * (C1 - 4.0 * mean) + PSF[4] * (C2 - 8.0 * mean) + PSF[5] * (C3 - 4.0 * mean) +
                 PSF[6] * (D1 - 4.0 * mean) + PSF[7] * (D2 - 8.0 * mean) + PSF[8] * (D3 - 44.0 * mean);
 
-            dst.px[width * y + x] = (float) PSF_fit;
-        }
-    }
-}
-
-static void Downsample(FloatImg& dst, const FloatImg& src, int downsample)
-{
-    int width = src.Size.GetWidth();
-    int dw = src.Size.GetWidth() / downsample;
-    int dh = src.Size.GetHeight() / downsample;
-
-    dst.Init(wxSize(dw, dh));
-
-    for (int yy = 0; yy < dh; yy++)
-    {
-        for (int xx = 0; xx < dw; xx++)
-        {
-            float sum = 0.0;
-            for (int j = 0; j < downsample; j++)
-                for (int i = 0; i < downsample; i++)
-                    sum += src.px[(yy * downsample + j) * width + xx * downsample + i];
-            float val = sum / (downsample * downsample);
-            dst.px[yy * dw + xx] = val;
+            drow[x] = (float) PSF_fit;
         }
     }
 }
@@ -488,8 +505,25 @@ static void RemoveItems(std::set<Peak>& stars, const std::set<int>& to_erase)
     }
 }
 
-bool Star::AutoFind(const usImage& image, int extraEdgeAllowance, int searchRegion)
+// A local maximum found while scanning the bands. The star intensity measure
+// is relative to the global standard deviation, which is not known until the
+// last band has been processed, so candidates are kept by their height above
+// the local mean and ranked once the scan is complete.
+struct Candidate
 {
+    int x;
+    int y;
+    double height;
+    unsigned int seq; // scan order
+
+    bool operator<(const Candidate& rhs) const { return seq < rhs.seq; }
+};
+
+// Locate the candidate guide stars in a full frame, sorted by ascending intensity.
+static bool FindPeaks(const usImage& image, int extraEdgeAllowance, int searchRegion, std::set<Peak>& stars)
+{
+    stars.clear();
+
     if (!image.Subframe.IsEmpty())
     {
         Debug.AddLine("Autofind called on subframe, returning error");
@@ -500,100 +534,138 @@ bool Star::AutoFind(const usImage& image, int extraEdgeAllowance, int searchRegi
 
     Debug.AddLine(wxString::Format("Star::AutoFind called with edgeAllowance = %d searchRegion = %d", extraEdgeAllowance, searchRegion));
 
-    // run a 3x3 median first to eliminate hot pixels
-    usImage smoothed;
-    smoothed.CopyFrom(image);
-    Median3(smoothed);
+    int const width = image.Size.GetWidth();
+    int const height = image.Size.GetHeight();
+    wxRect convRect(CONV_RADIUS, CONV_RADIUS, width - 2 * CONV_RADIUS, height - 2 * CONV_RADIUS);  // region containing valid data
 
-    // convert to floating point
-    FloatImg conv(smoothed);
-
-    // downsample the source image
-    const int downsample = 1;
-    if (downsample > 1)
+    if (convRect.GetWidth() <= 2 * MAX_SRCH || convRect.GetHeight() <= 2 * MAX_SRCH)
     {
-        FloatImg tmp;
-        Downsample(tmp, conv, downsample);
-        conv.Swap(tmp);
+        Debug.AddLine("Autofind: image is too small");
+        return false;
     }
 
-    // run the PSF convolution
-    {
-        FloatImg tmp;
-        psf_conv(tmp, conv);
-        conv.Swap(tmp);
-    }
+    // scratch buffers for one band: the 3x3 median (which eliminates hot
+    // pixels) and the PSF convolution, each with overlap for the neighboring bands
+    enum { MAX_CONV_ROWS = BAND_ROWS + 2 * LOCAL_RADIUS };
+    enum { MAX_MEDIAN_ROWS = MAX_CONV_ROWS + 2 * CONV_RADIUS };
+    std::vector<unsigned short> median(MAX_MEDIAN_ROWS * width);
+    ConvBand conv(width, MAX_CONV_ROWS);
 
-    enum { CONV_RADIUS = 4 };
-    int dw = conv.Size.GetWidth();      // width of the downsampled image
-    int dh = conv.Size.GetHeight();     // height of the downsampled image
-    wxRect convRect(CONV_RADIUS, CONV_RADIUS, dw - 2 * CONV_RADIUS, dh - 2 * CONV_RADIUS);  // region containing valid data
+    // Keep more than TOP_N candidates: distinct candidates can end up with
+    // the same intensity once normalized, so a little slack guarantees the
+    // final TOP_N selection is the same as ranking the whole frame at once.
+    enum { TOP_N = 100 };  // keep track of the brightest stars
+    enum { MAX_CANDIDATES = 2 * TOP_N };
+    std::map<double, Candidate> candidates;  // sorted by ascending height above local mean
+    unsigned int seq = 0;
 
-    SaveImage(conv, "PHD2_AutoFind.fit");
+    RunningStats global;
 
-    enum { TOP_N = 100 };  // keep track of the brightest stars
-    std::set<Peak> stars;  // sorted by ascending intensity
+    for (int bandTop = convRect.GetTop(); bandTop <= convRect.GetBottom(); bandTop += BAND_ROWS)
+    {
+        int const bandBottom = wxMin(bandTop + BAND_ROWS - 1, convRect.GetBottom());
 
-    double global_mean, global_stdev;
-    GetStats(&global_mean, &global_stdev, conv, convRect);
+        // rows of convolved data needed for the local statistics of this band
+        int const convTop = wxMax(convRect.GetTop(), bandTop - LOCAL_RADIUS);
+        int const convBottom = wxMin(convRect.GetBottom(), bandBottom + LOCAL_RADIUS);
+        int const medianTop = convTop - CONV_RADIUS;
+        int const medianRows = convBottom + CONV_RADIUS - medianTop + 1;
 
-    Debug.AddLine("AutoFind: global mean = %.1f, stdev %.1f", global_mean, global_stdev);
+        Median3Rows(&median[0], image.ImageData, image.Size, medianTop, medianRows);
 
-    const double threshold = 0.1;
-    Debug.AddLine("AutoFind: using threshold = %.1f", threshold);
+        conv.Y0 = convTop;
+        conv.Rows = convBottom - convTop + 1;
+        psf_conv(conv, &median[0], medianTop);
 
-    // find each local maximum
-    int srch = 4;
-    for (int y = convRect.GetTop() + srch; y <= convRect.GetBottom() - srch; y++)
-    {
-        for (int x = convRect.GetLeft() + srch; x <= convRect.GetRight() - srch; x++)
+        AccumStats(global, conv, wxRect(convRect.GetLeft(), bandTop, convRect.GetWidth(), bandBottom - bandTop + 1));
+
+        // find each local maximum
+        int const srch = MAX_SRCH;
+        int const yStart = wxMax(bandTop, convRect.GetTop() + srch);
+        int const yEnd = wxMin(bandBottom, convRect.GetBottom() - srch);
+        for (int y = yStart; y <= yEnd; y++)
         {
-            float val = conv.px[dw * y + x];
-            bool ismax = false;
-            if (val > 0.0)
+            for (int x = convRect.GetLeft() + srch; x <= convRect.GetRight() - srch; x++)
             {
-                ismax = true;
-                for (int j = -srch; j <= srch; j++)
+                float val = conv.Row(y)[x];
+                bool ismax = false;
+                if (val > 0.0)
                 {
-                    for (int i = -srch; i <= srch; i++)
+                    ismax = true;
+                    for (int j = -srch; j <= srch; j++)
                     {
-                        if (i == 0 && j == 0)
-                            continue;
-                        if (conv.px[dw * (y + j) + (x + i)] > val)
+                        const float *row = conv.Row(y + j);
+                        for (int i = -srch; i <= srch; i++)
                         {
-                            ismax = false;
-                            break;
+                            if (i == 0 && j == 0)
+                                continue;
+                            if (row[x + i] > val)
+                            {
+                                ismax = false;
+                                break;
+                            }
                         }
                     }
                 }
-            }
-            if (!ismax)
-                continue;
+                if (!ismax)
+                    continue;
 
-            // compare local maximum to mean value of surrounding pixels
-            const int local = 7;
-            double local_mean, local_stdev;
-            wxRect localRect(x - local, y - local, 2 * local + 1, 2 * local + 1);
-            localRect.Intersect(convRect);
-            GetStats(&local_mean, &local_stdev, conv, localRect);
+                // compare local maximum to mean value of surrounding pixels
+                const int local = LOCAL_RADIUS;
+                double local_mean, local_stdev;
+                wxRect localRect(x - local, y - local, 2 * local + 1, 2 * local + 1);
+                localRect.Intersect(convRect);
+                GetStats(&local_mean, &local_stdev, conv, localRect);
 
-            // this is our measure of star intensity
-            double h = (val - local_mean) / global_stdev;
+                double d = val - local_mean;
+                if (d <= 0.0)
+                    continue;
 
-            if (h < threshold)
-            {
-                //  Debug.AddLine(wxString::Format("AG: local max REJECT [%d, %d] PSF %.1f SNR %.1f", imgx, imgy, val, SNR));
-                continue;
+                // the first candidate with a given height wins, as with std::set::insert
+                if (candidates.find(d) != candidates.end())
+                    continue;
+
+                Candidate c;
+                c.x = x;
+                c.y = y;
+                c.height = d;
+                c.seq = seq++;
+                candidates.insert(std::make_pair(d, c));
+                if (candidates.size() > MAX_CANDIDATES)
+                    candidates.erase(candidates.begin());
             }
+        }
+    }
 
-            // coordinates on the original image
-            int imgx = x * downsample + downsample / 2;
-            int imgy = y * downsample + downsample / 2;
+    double global_mean = global.Mean();
+    double global_stdev = global.Stdev();
 
-            stars.insert(Peak(imgx, imgy, h));
-            if (stars.size() > TOP_N)
-                stars.erase(stars.begin());
+    Debug.AddLine("AutoFind: global mean = %.1f, stdev %.1f", global_mean, global_stdev);
+
+    const double threshold = 0.1;
+    Debug.AddLine("AutoFind: using threshold = %.1f", threshold);
+
+    // rank the candidates by intensity, visiting them in scan order
+    std::vector<Candidate> ordered;
+    ordered.reserve(candidates.size());
+    for (std::map<double, Candidate>::const_iterator it = candidates.begin(); it != candidates.end(); ++it)
+        ordered.push_back(it->second);
+    std::sort(ordered.begin(), ordered.end());
+
+    for (std::vector<Candidate>::const_iterator c = ordered.begin(); c != ordered.end(); ++c)
+    {
+        // this is our measure of star intensity
+        double h = c->height / global_stdev;
+
+        if (h < threshold)
+        {
+            //  Debug.AddLine(wxString::Format("AG: local max REJECT [%d, %d] PSF %.1f SNR %.1f", imgx, imgy, val, SNR));
+            continue;
         }
+
+        stars.insert(Peak(c->x, c->y, h));
+        if (stars.size() > TOP_N)
+            stars.erase(stars.begin());
     }
 
     for (std::set<Peak>::const_reverse_iterator it = stars.rbegin(); it != stars.rend(); ++it)
@@ -678,6 +750,16 @@ bool Star::AutoFind(const usImage& image, int extraEdgeAllowance, int searchRegi
         }
     }
 
+    return true;
+}
+
+bool Star::AutoFind(const usImage& image, int extraEdgeAllowance, int searchRegion)
+{
+    std::set<Peak> stars;  // sorted by ascending intensity
+
+    if (!FindPeaks(image, extraEdgeAllowance, searchRegion, stars))
+        return false;
+
     // At first I tried running Star::Find on the survivors to find the best
     // star. This had the unfortunate effect of locating hot pixels which
     // the psf convolution so nicely avoids. So, don't do that!  -ag
@@ -716,3 +798,28 @@ bool Star::AutoFind(const usImage& image, int extraEdgeAllowance, int searchRegi
     Debug.AddLine("Autofind: no star found");
     return false;
 }
+
+bool Star::AutoFindStars(const usImage& image, int extraEdgeAllowance, int searchRegion, unsigned int maxStars, std::vector<Star> *foundStars)
+{
+    foundStars->clear();
+
+    std::set<Peak> stars;  // sorted by ascending intensity
+
+    if (!FindPeaks(image, extraEdgeAllowance, searchRegion, stars))
+        return false;
+
+    // take the brightest stars, skipping saturated stars since their
+    // centroids are not reliable enough to be averaged with the others
+    for (std::set<Peak>::reverse_iterator it = stars.rbegin(); it != stars.rend() && foundStars->size() < maxStars; ++it)
+    {
+        Star tmp;
+        tmp.Find(&image, searchRegion, it->x, it->y, FIND_CENTROID);
+        if (!tmp.WasFound() || tmp.GetError() == STAR_SATURATED)
+            continue;
+        foundStars->push_back(tmp);
+    }
+
+    Debug.AddLine("AutoFindStars: found %u stars", (unsigned int) foundStars->size());
+
+    return !foundStars->empty();
+}
@@ -47,6 +47,7 @@ public:
     {
         FIND_CENTROID,
         FIND_PEAK,
+        FIND_PSF_FIT,
     };
 
     enum FindResult
@@ -74,12 +75,17 @@ public:
     bool Find(const usImage *pImg, int searchRegion, FindMode mode);
     bool Find(const usImage *pImg, int searchRegion, int X, int Y, FindMode mode);
     bool AutoFind(const usImage& image, int edgeAllowance, int searchRegion);
+    static bool AutoFindStars(const usImage& image, int edgeAllowance, int searchRegion, unsigned int maxStars, std::vector<Star> *foundStars);
 
     bool WasFound(FindResult result);
     bool WasFound(void);
     void Invalidate(void);
     void SetError(FindResult error);
     FindResult GetError(void) const;
+
+    // PSF model used by FIND_PSF_FIT
+    static void SetPsfModel(PsfModel model);
+    static PsfModel GetPsfModel(void);
 private:
     FindResult m_lastFindResult;
 };
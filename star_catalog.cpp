@@ -0,0 +1,230 @@
+/*
+ *  star_catalog.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2016 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "phd.h"
+
+enum
+{
+    CATALOG_MAX_STARS = 32,
+    CATALOG_REFRESH_MS = 15000,     // minimum time between scans
+    AUTOSELECT_MAX_AGE_MS = 30000,  // older catalogs are not trusted for star selection
+    AUTOSELECT_MAX_TRIES = 3,
+    AUTOFIND_EDGE_DIST = 40,        // same edge margin as Star::AutoFind
+    MATCH_TOLERANCE_PX = 3,
+};
+
+class StarCatalog::Scanner : public wxThread
+{
+    StarCatalog *m_catalog;
+
+public:
+    Scanner(StarCatalog *catalog)
+        : wxThread(wxTHREAD_JOINABLE), m_catalog(catalog) { }
+
+    ExitCode Entry(void)
+    {
+        m_catalog->ScanFrames();
+        return 0;
+    }
+};
+
+StarCatalog::StarCatalog(void)
+    : m_wakeup(m_lock),
+      m_scanner(0),
+      m_stop(false),
+      m_pending(0),
+      m_pendingSearchRegion(0),
+      m_scanning(false),
+      m_lastOffer(0),
+      m_catalogTime(0)
+{
+    Scanner *scanner = new Scanner(this);
+
+    if (scanner->Create() != wxTHREAD_NO_ERROR)
+    {
+        Debug.AddLine("StarCatalog: could not create scanner thread");
+        delete scanner;
+        return;
+    }
+
+    scanner->SetPriority(WXTHREAD_MIN_PRIORITY);
+
+    if (scanner->Run() != wxTHREAD_NO_ERROR)
+    {
+        Debug.AddLine("StarCatalog: could not start scanner thread");
+        delete scanner;
+        return;
+    }
+
+    m_scanner = scanner;
+}
+
+StarCatalog::~StarCatalog(void)
+{
+    if (m_scanner)
+    {
+        {
+            wxMutexLocker lock(m_lock);
+            m_stop = true;
+            m_wakeup.Signal();
+        }
+        m_scanner->Wait();
+        delete m_scanner;
+    }
+
+    delete m_pending;
+}
+
+void StarCatalog::ScanFrames(void)
+{
+    wxMutexLocker lock(m_lock);
+
+    while (true)
+    {
+        while (!m_pending && !m_stop)
+            m_wakeup.Wait();
+
+        if (m_stop)
+            break;
+
+        usImage *img = m_pending;
+        int searchRegion = m_pendingSearchRegion;
+        m_pending = 0;
+        m_scanning = true;
+
+        m_lock.Unlock();
+
+        std::vector<Star> stars;
+        Star::AutoFindStars(*img, 0, searchRegion, CATALOG_MAX_STARS, &stars);
+        wxSize frameSize = img->Size;
+        delete img;
+
+        m_lock.Lock();
+
+        m_stars.swap(stars);
+        m_frameSize = frameSize;
+        m_catalogTime = ::wxGetUTCTimeMillis().GetValue();
+        m_scanning = false;
+
+        Debug.AddLine("StarCatalog: %u stars", (unsigned int) m_stars.size());
+    }
+}
+
+// Called from the main thread with each new frame. Full frames are handed to
+// the scanner thread every CATALOG_REFRESH_MS; the copy is the only work done
+// on the calling thread.
+void StarCatalog::OfferFrame(const usImage& img, int searchRegion)
+{
+    if (!m_scanner || img.Subframe.GetWidth() > 0 || !img.ImageData)
+        return;
+
+    wxLongLong_t now = ::wxGetUTCTimeMillis().GetValue();
+
+    {
+        wxMutexLocker lock(m_lock);
+        if (m_scanning || m_pending || now - m_lastOffer < CATALOG_REFRESH_MS)
+            return;
+        m_lastOffer = now;
+    }
+
+    usImage *copy = new usImage();
+    if (copy->CopyFrom(img))
+    {
+        delete copy;
+        return;
+    }
+
+    wxMutexLocker lock(m_lock);
+    m_pending = copy;
+    m_pendingSearchRegion = searchRegion;
+    m_wakeup.Signal();
+}
+
+bool StarCatalog::GetStars(const wxSize& frameSize, unsigned int maxAgeMs, std::vector<Star> *stars)
+{
+    wxLongLong_t now = ::wxGetUTCTimeMillis().GetValue();
+
+    wxMutexLocker lock(m_lock);
+
+    if (m_stars.empty() || m_frameSize != frameSize || now - m_catalogTime > maxAgeMs)
+        return false;
+
+    *stars = m_stars;
+    return true;
+}
+
+void StarCatalog::Clear(void)
+{
+    wxMutexLocker lock(m_lock);
+    m_stars.clear();
+    m_lastOffer = 0;
+}
+
+// Select a guide star from the catalog, checking that it is still where the
+// catalog says it is in the current frame. Returns true if a star was found
+// (like Star::AutoFind).
+bool StarCatalog::FindBestStar(const usImage& img, int edgeAllowance, int searchRegion, Star *star)
+{
+    std::vector<Star> stars;
+    if (!GetStars(img.Size, AUTOSELECT_MAX_AGE_MS, &stars))
+        return false;
+
+    int const edgeDist = AUTOFIND_EDGE_DIST + edgeAllowance;
+    unsigned int tries = 0;
+
+    for (std::vector<Star>::const_iterator it = stars.begin(); it != stars.end() && tries < AUTOSELECT_MAX_TRIES; ++it)
+    {
+        if (it->X <= edgeDist || it->X >= img.Size.GetWidth() - edgeDist ||
+            it->Y <= edgeDist || it->Y >= img.Size.GetHeight() - edgeDist)
+        {
+            continue;
+        }
+
+        ++tries;
+
+        Star tmp;
+        if (!tmp.Find(&img, searchRegion, ROUND(it->X), ROUND(it->Y), Star::FIND_CENTROID) ||
+            tmp.GetError() == Star::STAR_SATURATED ||
+            tmp.Distance(*it) > MATCH_TOLERANCE_PX)
+        {
+            Debug.AddLine("StarCatalog: star at (%.1f, %.1f) not confirmed", it->X, it->Y);
+            continue;
+        }
+
+        Debug.AddLine("StarCatalog: selected star at (%.1f, %.1f)", tmp.X, tmp.Y);
+        *star = tmp;
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,72 @@
+/*
+ *  star_catalog.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2016 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef STAR_CATALOG_H_INCLUDED
+#define STAR_CATALOG_H_INCLUDED
+
+// A ranked list of the usable stars in the field, kept up to date by a low
+// priority thread that runs Star::AutoFindStars on a full frame every so
+// often. The guider uses it to select a star without scanning the frame and
+// to recognize the guide star among its neighbors after it has been lost.
+class StarCatalog
+{
+    class Scanner;
+
+    wxMutex m_lock;
+    wxCondition m_wakeup;
+    Scanner *m_scanner;
+    bool m_stop;
+
+    usImage *m_pending;             // frame waiting to be scanned
+    int m_pendingSearchRegion;
+    bool m_scanning;
+    wxLongLong_t m_lastOffer;
+
+    std::vector<Star> m_stars;      // brightest first
+    wxSize m_frameSize;
+    wxLongLong_t m_catalogTime;
+
+    void ScanFrames(void);
+
+public:
+    StarCatalog(void);
+    ~StarCatalog(void);
+
+    void OfferFrame(const usImage& img, int searchRegion);
+    bool GetStars(const wxSize& frameSize, unsigned int maxAgeMs, std::vector<Star> *stars);
+    void Clear(void);
+
+    bool FindBestStar(const usImage& img, int edgeAllowance, int searchRegion, Star *star);
+};
+
+#endif /* STAR_CATALOG_H_INCLUDED */
@@ -97,7 +97,7 @@ void ProfileWindow::UpdateData(usImage *pImg, float xpos, float ypos) {
     for (x=0; x<21; x++, uptr++)
         midrow_profile[x] = (int) *uptr;
     if (this->visible)
-        Refresh();
+        pFrame->m_uiRefresh.Request(UI_REFRESH_PROFILE);
 
 }
 
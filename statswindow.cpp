@@ -105,6 +105,31 @@ StatsWindow::StatsWindow(wxWindow *parent)
     m_grid2->SetCellValue(3, 1, _T(""));
     m_grid2->ClearSelection();
 
+    m_grid3 = new wxGrid(this, wxID_ANY);
+    m_grid3->CreateGrid(STAGE_COUNT + 1, 4);
+    m_grid3->SetRowLabelSize(1);
+    m_grid3->SetColLabelSize(1);
+    m_grid3->EnableEditing(false);
+    m_grid3->SetCellBackgroundColour(*wxBLACK);
+    m_grid3->SetCellTextColour(*wxLIGHT_GREY);
+    m_grid3->SetGridLineColour(wxColour(40, 40, 40));
+
+    row = 0, col = 0;
+    m_grid3->SetCellValue(row, col++, _("Performance (ms)"));
+    m_grid3->SetCellValue(row, col++, _("p50"));
+    m_grid3->SetCellValue(row, col++, _("p95"));
+    m_grid3->SetCellValue(row, col++, _("p99"));
+    for (int i = 0; i < STAGE_COUNT; i++)
+    {
+        ++row, col = 0;
+        m_grid3->SetCellValue(row, col++, GuideCycleStats::StageLabel((GuideCycleStage) i));
+    }
+    m_grid3->SetCellValue(1, 1, _T(" 99999.9"));
+
+    m_grid3->AutoSize();
+    m_grid3->SetCellValue(1, 1, _T(""));
+    m_grid3->ClearSelection();
+
     wxSizer *sizer1 = new wxBoxSizer(wxHORIZONTAL);
 
     wxButton *clearButton = new wxButton(this, BUTTON_GRAPH_CLEAR, _("Clear"));
@@ -123,6 +148,7 @@ StatsWindow::StatsWindow(wxWindow *parent)
     sizer2->Add(sizer1, 0, wxEXPAND, 10);
     sizer2->Add(m_grid1, wxSizerFlags(0).Border(wxALL, 10));
     sizer2->Add(m_grid2, wxSizerFlags(0).Border(wxALL, 10));
+    sizer2->Add(m_grid3, wxSizerFlags(0).Border(wxALL, 10));
 
     SetSizerAndFit(sizer2);
 }
@@ -203,6 +229,33 @@ void StatsWindow::UpdateStats(void)
 
     m_grid1->EndBatch();
     m_grid2->EndBatch();
+
+    UpdateCycleStats();
+}
+
+void StatsWindow::UpdateCycleStats(void)
+{
+    m_grid3->BeginBatch();
+
+    for (int i = 0; i < STAGE_COUNT; i++)
+    {
+        int row = i + 1, col = 1;
+        double p50, p95, p99;
+        if (CycleStats.Stage((GuideCycleStage) i).GetPercentiles(&p50, &p95, &p99))
+        {
+            m_grid3->SetCellValue(wxString::Format(" %.1f", p50), row, col++);
+            m_grid3->SetCellValue(wxString::Format(" %.1f", p95), row, col++);
+            m_grid3->SetCellValue(wxString::Format(" %.1f", p99), row, col++);
+        }
+        else
+        {
+            m_grid3->SetCellValue(_T(""), row, col++);
+            m_grid3->SetCellValue(_T(""), row, col++);
+            m_grid3->SetCellValue(_T(""), row, col++);
+        }
+    }
+
+    m_grid3->EndBatch();
 }
 
 static wxString RotatorPosStr()
@@ -250,4 +303,7 @@ void StatsWindow::OnMenuLength(wxCommandEvent& evt)
 void StatsWindow::OnButtonClear(wxCommandEvent& evt)
 {
     pFrame->pGraphLog->OnButtonClear(evt);
+    CycleStats.Reset();
+    if (m_visible)
+        UpdateCycleStats();
 }
@@ -42,12 +42,14 @@ class StatsWindow : public wxWindow
     bool m_visible;
     wxGrid *m_grid1;
     wxGrid *m_grid2;
+    wxGrid *m_grid3;
     int m_length;
     OptionsButton *m_pLengthButton;
 
     void OnButtonLength(wxCommandEvent&);
     void OnMenuLength(wxCommandEvent&);
     void OnButtonClear(wxCommandEvent&);
+    void UpdateCycleStats(void);
 
 public:
     StatsWindow(wxWindow *parent);
@@ -143,7 +143,7 @@ void TargetWindow::AppendData(const GuideStepInfo& step)
 
     if (this->m_visible)
     {
-        Refresh();
+        pFrame->m_uiRefresh.Request(UI_REFRESH_TARGET);
     }
 }
 
@@ -253,8 +253,8 @@ void TargetClient::AppendData(const GuideStepInfo& step)
 {
     memmove(&m_history, &m_history[1], sizeof(m_history[0])*(m_maxHistorySize-1));
 
-    m_history[m_maxHistorySize-1].ra = step.mountOffset->X;
-    m_history[m_maxHistorySize-1].dec = step.mountOffset->Y;
+    m_history[m_maxHistorySize-1].ra = step.mountOffset.X;
+    m_history[m_maxHistorySize-1].dec = step.mountOffset.Y;
 
     if (m_nItems < m_maxHistorySize)
     {
@@ -0,0 +1,222 @@
+/*
+ *  ui_refresh.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2016 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "phd.h"
+
+#include "guiding_assistant.h"
+
+enum
+{
+    REPORT_STEPS = 100,             // guide steps per debug log report
+};
+
+UIRefreshScheduler::UIRefreshScheduler(void)
+    : m_rate(0),
+      m_enabled(false),
+      m_pending(0),
+      m_scheduled(false),
+      m_steps(0),
+      m_refreshes(0),
+      m_appendUs(0),
+      m_refreshUs(0)
+{
+    m_timer.SetOwner(this);
+    Bind(wxEVT_TIMER, &UIRefreshScheduler::OnTimer, this);
+    Bind(wxEVT_THREAD, &UIRefreshScheduler::OnSchedule, this);
+}
+
+UIRefreshScheduler::~UIRefreshScheduler(void)
+{
+    m_timer.Stop();
+}
+
+void UIRefreshScheduler::Start(void)
+{
+    m_enabled = true;
+}
+
+void UIRefreshScheduler::Stop(void)
+{
+    m_enabled = false;
+    m_timer.Stop();
+
+    wxCriticalSectionLocker lock(m_lock);
+    m_pending = 0;
+    m_scheduled = false;
+}
+
+void UIRefreshScheduler::SetRate(int rate)
+{
+    m_rate = rate;
+
+    // a refresh waiting for the old interval waits for the new one instead
+    if (m_timer.IsRunning())
+    {
+        m_timer.Stop();
+        Schedule();
+    }
+}
+
+void UIRefreshScheduler::Request(unsigned int targets)
+{
+    if (wxIsMainThread() && m_rate == 0)
+    {
+        // not limited: refresh now, as the windows did before the scheduler
+        Refresh(targets);
+        return;
+    }
+
+    bool schedule;
+
+    {
+        wxCriticalSectionLocker lock(m_lock);
+        m_pending |= targets;
+        schedule = !m_scheduled;
+        m_scheduled = true;
+    }
+
+    if (!schedule)
+        return;
+
+    // the timer can only be started on the main thread
+    if (wxIsMainThread())
+        Schedule();
+    else
+        wxQueueEvent(this, new wxThreadEvent());
+}
+
+void UIRefreshScheduler::OnSchedule(wxThreadEvent& WXUNUSED(evt))
+{
+    Schedule();
+}
+
+// main thread: arrange for the pending targets to be refreshed
+void UIRefreshScheduler::Schedule(void)
+{
+    if (!m_enabled)
+    {
+        wxCriticalSectionLocker lock(m_lock);
+        m_pending = 0;
+        m_scheduled = false;
+        return;
+    }
+
+    if (m_rate > 0)
+        m_timer.Start(1000 / m_rate, wxTIMER_ONE_SHOT);
+    else
+        RefreshPending();
+}
+
+void UIRefreshScheduler::GuideStepAppended(wxLongLong_t appendUs)
+{
+    wxString msg;
+
+    {
+        wxCriticalSectionLocker lock(m_lock);
+
+        m_appendUs += appendUs;
+        if (++m_steps < REPORT_STEPS)
+            return;
+
+        msg = wxString::Format("UI refresh: %u guide steps, %u refreshes (limit %d/s), %.2f ms per step (append %.2f ms, refresh %.2f ms)",
+            m_steps, m_refreshes, m_rate,
+            (m_appendUs + m_refreshUs) / 1000.0 / m_steps, m_appendUs / 1000.0 / m_steps, m_refreshUs / 1000.0 / m_steps);
+
+        m_steps = 0;
+        m_refreshes = 0;
+        m_appendUs = 0;
+        m_refreshUs = 0;
+    }
+
+    Debug.AddLine(msg);
+}
+
+void UIRefreshScheduler::OnTimer(wxTimerEvent& WXUNUSED(evt))
+{
+    RefreshPending();
+}
+
+void UIRefreshScheduler::RefreshPending(void)
+{
+    unsigned int targets;
+
+    {
+        wxCriticalSectionLocker lock(m_lock);
+        targets = m_pending;
+        m_pending = 0;
+        m_scheduled = false;
+    }
+
+    if (targets)
+        Refresh(targets);
+}
+
+// Bring the requested windows up to date. When the rate is limited they are
+// painted now, so the time spent is measured here and not in a later paint
+// event; otherwise they are only invalidated, as before the scheduler.
+void UIRefreshScheduler::Refresh(unsigned int targets)
+{
+    if (!pFrame)
+        return;
+
+    wxLongLong_t start = LatencyStats::Now();
+
+    if ((targets & UI_REFRESH_STATS) && pFrame->pStatsWin)
+        pFrame->pStatsWin->UpdateStats();
+
+    if (targets & UI_REFRESH_ASSISTANT)
+        GuidingAssistant::UpdateDisplay();
+
+    wxWindow *windows[] =
+    {
+        (targets & UI_REFRESH_GRAPH) ? pFrame->pGraphLog : 0,
+        (targets & UI_REFRESH_TARGET) ? pFrame->pTarget : 0,
+        (targets & UI_REFRESH_PROFILE) ? pFrame->pProfile : 0,
+    };
+
+    for (unsigned int i = 0; i < WXSIZEOF(windows); i++)
+    {
+        if (windows[i])
+        {
+            windows[i]->Refresh();
+            if (m_rate > 0)
+                windows[i]->Update();
+        }
+    }
+
+    wxLongLong_t elapsed = LatencyStats::Now() - start;
+
+    wxCriticalSectionLocker lock(m_lock);
+    m_refreshUs += elapsed;
+    ++m_refreshes;
+}
@@ -0,0 +1,94 @@
+/*
+ *  ui_refresh.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2016 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef UI_REFRESH_H_INCLUDED
+#define UI_REFRESH_H_INCLUDED
+
+enum UIRefreshTarget
+{
+    UI_REFRESH_GRAPH        = 1 << 0,
+    UI_REFRESH_STATS        = 1 << 1,
+    UI_REFRESH_TARGET       = 1 << 2,
+    UI_REFRESH_PROFILE      = 1 << 3,
+    UI_REFRESH_ASSISTANT    = 1 << 4,
+};
+
+// Repaints the guiding display windows at a capped rate. The windows take
+// new data as it arrives, which is cheap, and request a refresh; the
+// refreshes requested since the last one are done together on the main
+// thread, so short exposures do not swamp it with repaints and grid updates.
+// The timer is one-shot: it is started by the first request after a
+// refresh, so nothing runs while the windows have nothing new to show.
+class UIRefreshScheduler : public wxEvtHandler
+{
+    wxTimer m_timer;
+    int m_rate;                 // refreshes per second, 0 = no limit
+    bool m_enabled;             // between Start and Stop
+
+    wxCriticalSection m_lock;
+    unsigned int m_pending;     // UIRefreshTarget bits
+    bool m_scheduled;           // a refresh is on its way for the pending targets
+
+    // main thread time spent on the display windows, reported per guide step
+    unsigned int m_steps;
+    unsigned int m_refreshes;
+    wxLongLong_t m_appendUs;
+    wxLongLong_t m_refreshUs;
+
+    void OnSchedule(wxThreadEvent& evt);
+    void OnTimer(wxTimerEvent& evt);
+    void Schedule(void);
+    void RefreshPending(void);
+    void Refresh(unsigned int targets);
+
+public:
+    UIRefreshScheduler(void);
+    ~UIRefreshScheduler(void);
+
+    void Start(void);
+    void Stop(void);
+
+    void SetRate(int rate);
+    int GetRate(void) const;
+
+    // may be called from any thread
+    void Request(unsigned int targets);
+    void GuideStepAppended(wxLongLong_t appendUs);
+};
+
+inline int UIRefreshScheduler::GetRate(void) const
+{
+    return m_rate;
+}
+
+#endif /* UI_REFRESH_H_INCLUDED */
@@ -35,6 +35,12 @@
 #include "phd.h"
 #include "image_math.h"
 
+usImage::~usImage()
+{
+    delete[] ImageData;
+    delete ImgAnalysis;
+}
+
 bool usImage::Init(const wxSize& size)
 {
     // Allocates space for image and sets params up
@@ -290,7 +296,7 @@ wxString usImage::GetImgStartTime() const
         timestruct->tm_mday,timestruct->tm_hour,timestruct->tm_min,timestruct->tm_sec);
 }
 
-bool usImage::Save(const wxString& fname, const wxString& hdrNote) const
+bool usImage::Save(const wxString& fname, const wxString& hdrNote, bool compress) const
 {
     bool bError = false;
 
@@ -307,6 +313,11 @@ bool usImage::Save(const wxString& fname, const wxString& hdrNote) const
         int status = 0;  // CFITSIO status value MUST be initialized to zero!
 
         PHD_fits_create_file(&fptr, fname, true, &status);
+        if (compress)
+        {
+            // lossless Rice tile compression, as fpack does
+            fits_set_compression_type(fptr, RICE_1, &status);
+        }
         fits_create_img(fptr, USHORT_IMG, 2, fsize, &status);
 
         float exposure = (float) ImgExpDur / 1000.0;
@@ -314,6 +325,24 @@ bool usImage::Save(const wxString& fname, const wxString& hdrNote) const
         char *comment = const_cast<char *>("Exposure time in seconds");
         fits_write_key(fptr, TFLOAT, keyname, &exposure, comment, &status);
 
+        if (ImgStartTime)
+        {
+            keyname = const_cast<char *>("DATE-OBS");
+            comment = const_cast<char *>("YYYY-MM-DDThh:mm:ss observation start, UT");
+            wxString dateobs = GetImgStartTime();
+            fits_write_key(fptr, TSTRING, keyname, const_cast<char *>(static_cast<const char *>(dateobs)), comment, &status);
+        }
+
+        if (!Subframe.IsEmpty())
+        {
+            // where the valid data is, so the Replay camera can play the frame back as a subframe
+            int subframe[4] = { Subframe.x, Subframe.y, Subframe.width, Subframe.height };
+            fits_write_key(fptr, TINT, const_cast<char *>("XORGSUB"), &subframe[0], const_cast<char *>("Subframe x position"), &status);
+            fits_write_key(fptr, TINT, const_cast<char *>("YORGSUB"), &subframe[1], const_cast<char *>("Subframe y position"), &status);
+            fits_write_key(fptr, TINT, const_cast<char *>("XSIZSUB"), &subframe[2], const_cast<char *>("Subframe width"), &status);
+            fits_write_key(fptr, TINT, const_cast<char *>("YSIZSUB"), &subframe[3], const_cast<char *>("Subframe height"), &status);
+        }
+
         if (ImgStackCnt > 1)
         {
             keyname = const_cast<char *>("STACKCNT");
@@ -369,10 +398,19 @@ bool usImage::Load(const wxString& fname)
             // Get HDUs and size
             int naxis = 0;
             fits_get_img_dim(fptr, &naxis, &status);
-            long fsize[3];
-            fits_get_img_size(fptr, 2, fsize, &status);
             int nhdus = 0;
             fits_get_num_hdus(fptr, &nhdus, &status);
+            if (nhdus == 2 && naxis == 0)
+            {
+                // compressed image, stored after an empty primary HDU
+                if (fits_movabs_hdu(fptr, 2, &hdutype, &status) == 0 && hdutype == IMAGE_HDU)
+                {
+                    fits_get_img_dim(fptr, &naxis, &status);
+                    nhdus = 1;
+                }
+            }
+            long fsize[3];
+            fits_get_img_size(fptr, 2, fsize, &status);
             if ((nhdus != 1) || (naxis != 2)) {
                 pFrame->Alert(_("Unsupported type or read error loading FITS file ") + fname);
                 throw ERROR_INFO("unsupported type");
@@ -35,6 +35,8 @@
 #ifndef USIMAGECLASS
 #define USIMAGECLASS
 
+struct FrameAnalysis;
+
 class usImage
 {
 public:
@@ -48,6 +50,11 @@ public:
     time_t              ImgStartTime;
     int                 ImgExpDur;
     int                 ImgStackCnt;
+    wxLongLong_t        ImgExposureStartUs; // LatencyStats::Now() timestamps for the guide cycle stats
+    wxLongLong_t        ImgExposureEndUs;
+    wxLongLong_t        ImgCapturedUs;      // when the camera returned the frame, for the frame age limit
+    wxLongLong_t        ImgDarkUs;          // time spent subtracting the dark frame or removing defects
+    FrameAnalysis      *ImgAnalysis;        // set by Guider::AnalyzeFrame, owned by the image
 
     usImage() {
         Min = Max = FiltMin = FiltMax = 0;
@@ -56,8 +63,10 @@ public:
         ImgStartTime = 0;
         ImgExpDur = 0;
         ImgStackCnt = 1;
+        ImgExposureStartUs = ImgExposureEndUs = ImgCapturedUs = ImgDarkUs = 0;
+        ImgAnalysis = NULL;
     }
-    ~usImage() { delete[] ImageData; }
+    ~usImage();
 
     bool                Init(const wxSize& size);
     bool                Init(int width, int height) { return Init(wxSize(width, height)); }
@@ -70,7 +79,7 @@ public:
     bool                BinnedCopyToImage(wxImage **img, int blevel, int wlevel, double power); // Does 2x2 bin during copy
     bool                CopyFromImage(const wxImage& img);
     bool                Load(const wxString& fname);
-    bool                Save(const wxString& fname, const wxString& hdrComment = wxEmptyString) const;
+    bool                Save(const wxString& fname, const wxString& hdrComment = wxEmptyString, bool compress = false) const;
     bool                Rotate(double theta, bool mirror=false);
     unsigned short&     Pixel(int x, int y) { return ImageData[y * Size.x + x]; }
     const unsigned short& Pixel(int x, int y) const { return ImageData[y * Size.x + x]; }
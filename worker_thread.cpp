@@ -38,7 +38,10 @@
 WorkerThread::WorkerThread(MyFrame *pFrame)
     : wxThread(wxTHREAD_JOINABLE),
       m_interruptRequested(0),
-      m_killable(true)
+      m_interruptChanged(m_interruptLock),
+      m_killable(true),
+      m_queueNotEmpty(m_queueLock),
+      m_highPriorityCount(0)
 {
     m_pFrame = pFrame;
     Debug.AddLine("WorkerThread constructor called");
@@ -51,29 +54,66 @@ WorkerThread::~WorkerThread(void)
 
 void WorkerThread::EnqueueMessage(const WORKER_THREAD_REQUEST& message)
 {
-    wxMessageQueueError queueError;
+    WORKER_THREAD_REQUEST queued(message);
+    queued.enqueueTime = LatencyStats::Now();
 
-    if (message.request == REQUEST_EXPOSE)
+    wxMutexLocker lock(m_queueLock);
+
+    if (queued.request == REQUEST_EXPOSE)
     {
-        queueError = m_lowPriorityQueue.Post(message);
+        m_queue.push_back(queued);
     }
     else
     {
-        queueError = m_highPriorityQueue.Post(message);
+        m_queue.insert(m_queue.begin() + m_highPriorityCount, queued);
+        ++m_highPriorityCount;
     }
 
-    assert(queueError == wxMSGQUEUE_NO_ERROR);
+    m_queueNotEmpty.Signal();
+}
+
+void WorkerThread::DequeueMessage(WORKER_THREAD_REQUEST *message)
+{
+    wxMutexLocker lock(m_queueLock);
 
-    queueError = m_wakeupQueue.Post(true);
+    while (m_queue.empty())
+    {
+        m_queueNotEmpty.Wait();
+    }
 
-    assert(queueError == wxMSGQUEUE_NO_ERROR);
+    *message = m_queue.front();
+    m_queue.pop_front();
+    if (m_highPriorityCount > 0)
+        --m_highPriorityCount;
+}
+
+void WorkerThread::LogQueueLatency(void)
+{
+    double p50, p95, p99;
+    unsigned int n = m_moveLatency.GetPercentiles(&p50, &p95, &p99);
+    Debug.AddLine("WorkerThread queue latency: move p50=%.2f p95=%.2f p99=%.2f ms (n=%u)", p50, p95, p99, n);
+    n = m_exposeLatency.GetPercentiles(&p50, &p95, &p99);
+    Debug.AddLine("WorkerThread queue latency: expose p50=%.2f p95=%.2f p99=%.2f ms (n=%u)", p50, p95, p99, n);
+}
+
+void WorkerThread::SetInterruptBits(unsigned int bits)
+{
+    wxMutexLocker lock(m_interruptLock);
+    m_interruptRequested |= bits;
+    m_interruptChanged.Broadcast();
+}
+
+void WorkerThread::ClearInterruptBits(unsigned int bits)
+{
+    wxMutexLocker lock(m_interruptLock);
+    m_interruptRequested &= ~bits;
 }
 
 /*************      Terminate      **************************/
 
 void WorkerThread::EnqueueWorkerThreadTerminateRequest(void)
 {
-    m_interruptRequested = INT_STOP | INT_TERMINATE;
+    SetInterruptBits(INT_STOP | INT_TERMINATE);
 
     WORKER_THREAD_REQUEST message;
     memset(&message, 0, sizeof(message));
@@ -86,7 +126,7 @@ void WorkerThread::EnqueueWorkerThreadTerminateRequest(void)
 
 void WorkerThread::EnqueueWorkerThreadExposeRequest(usImage *pImage, int exposureDuration, int exposureOptions, const wxRect& subframe)
 {
-    m_interruptRequested &= ~INT_STOP;
+    ClearInterruptBits(INT_STOP);
 
     WORKER_THREAD_REQUEST message;
     memset(&message, 0, sizeof(message));
@@ -103,30 +143,35 @@ void WorkerThread::EnqueueWorkerThreadExposeRequest(usImage *pImage, int exposur
     EnqueueMessage(message);
 }
 
+// Sleep for ms milliseconds, or until one of the checkInterrupts bits is set.
+// Returns the interrupt bits that ended the wait, or 0 if it timed out.
 unsigned int WorkerThread::MilliSleep(int ms, unsigned int checkInterrupts)
 {
-    enum { MAX_SLEEP = 100 };
+    WorkerThread *thr = WorkerThread::This();
 
-    if (ms <= MAX_SLEEP)
+    if (!thr)
     {
+        // not on a worker thread, there is nothing to interrupt the sleep
         if (ms > 0)
             wxMilliSleep(ms);
-        return WorkerThread::InterruptRequested() & checkInterrupts;
+        return 0;
     }
 
-    WorkerThread *thr = WorkerThread::This();
     wxStopWatch swatch;
+    wxMutexLocker lock(thr->m_interruptLock);
 
-    long elapsed = 0;
-    do {
-        wxMilliSleep(wxMin((long) ms - elapsed, (long) MAX_SLEEP));
-        unsigned int val = thr ? (thr->m_interruptRequested & checkInterrupts) : 0;
+    while (true)
+    {
+        unsigned int val = thr->m_interruptRequested & checkInterrupts;
         if (val)
             return val;
-        elapsed = swatch.Time();
-    } while (elapsed < ms);
 
-    return 0;
+        long remaining = ms - swatch.Time();
+        if (remaining <= 0)
+            return 0;
+
+        thr->m_interruptChanged.WaitTimeout(remaining);
+    }
 }
 
 bool WorkerThread::HandleExpose(MyFrame::EXPOSE_REQUEST *req)
@@ -140,16 +185,36 @@ bool WorkerThread::HandleExpose(MyFrame::EXPOSE_REQUEST *req)
             throw ERROR_INFO("Time lapse interrupted");
         }
 
+        req->pImage->ImgExposureStartUs = LatencyStats::Now();
+
         if (pCamera->HasNonGuiCapture())
         {
             Debug.Write(wxString::Format("Handling exposure in thread, d=%d o=%x r=(%d,%d,%d,%d)\n", req->exposureDuration,
                                          req->options, req->subframe.x, req->subframe.y, req->subframe.width, req->subframe.height));
 
-            req->pImage->InitImgStartTime();
+            if (pCamera->HasStreaming())
+            {
+                // the camera keeps exposing between requests; only a change of
+                // settings reaches the camera, and the frame carries its own
+                // start time
+                if (pCamera->StartStream(req->exposureDuration, req->options, req->subframe))
+                {
+                    throw ERROR_INFO("StartStream failed");
+                }
 
-            if (pCamera->Capture(req->exposureDuration, *req->pImage, req->options, req->subframe))
+                if (pCamera->NextFrame(req->exposureDuration, *req->pImage))
+                {
+                    throw ERROR_INFO("NextFrame failed");
+                }
+            }
+            else
             {
-                throw ERROR_INFO("Capture failed");
+                req->pImage->InitImgStartTime();
+
+                if (pCamera->Capture(req->exposureDuration, *req->pImage, req->options, req->subframe))
+                {
+                    throw ERROR_INFO("Capture failed");
+                }
             }
         }
         else
@@ -175,19 +240,40 @@ bool WorkerThread::HandleExpose(MyFrame::EXPOSE_REQUEST *req)
 
         if (!bError)
         {
-            switch (m_pFrame->GetNoiseReductionMethod())
+            usImage *img = req->pImage;
+
+            // the camera only reports when the frame is available, so the
+            // end of the exposure is taken to be the requested duration
+            // after the start. Streamed frames were stamped when the camera
+            // delivered them.
+            if (!img->ImgCapturedUs)
+                img->ImgCapturedUs = LatencyStats::Now();
+            img->ImgExposureEndUs = img->ImgExposureStartUs + (wxLongLong_t) req->exposureDuration * 1000;
+            CycleStats.AddSample(STAGE_DOWNLOAD, wxMax(img->ImgCapturedUs - img->ImgExposureEndUs - img->ImgDarkUs, (wxLongLong_t) 0));
+
+            NOISE_REDUCTION_METHOD nrMethod = m_pFrame->GetNoiseReductionMethod();
+            switch (nrMethod)
             {
                 case NR_NONE:
                     break;
                 case NR_2x2MEAN:
-                    QuickLRecon(*req->pImage);
+                    QuickLRecon(*img);
                     break;
                 case NR_3x3MEDIAN:
-                    Median3(*req->pImage);
+                    Median3(*img);
                     break;
             }
 
-            req->pImage->CalcStats();
+            if (nrMethod != NR_NONE)
+            {
+                wxLongLong_t t = LatencyStats::Now();
+                CycleStats.AddSample(STAGE_NOISE_REDUCTION, t - now);
+                now = t;
+            }
+
+            img->CalcStats();
+
+            CycleStats.AddSample(STAGE_STATS, LatencyStats::Now() - now);
         }
     }
     catch (wxString Msg)
@@ -201,6 +287,10 @@ bool WorkerThread::HandleExpose(MyFrame::EXPOSE_REQUEST *req)
 
 void WorkerThread::SendWorkerThreadExposeComplete(usImage *pImage, bool bError)
 {
+    // the processing thread sends the event after analysing the frame
+    if (!m_pFrame->ScheduleFrameAnalysis(pImage, bError))
+        return;
+
     wxThreadEvent *event = new wxThreadEvent(wxEVT_THREAD, MYFRAME_WORKER_THREAD_EXPOSE_COMPLETE);
     event->SetPayload<usImage *>(pImage);
     event->SetInt(bError);
@@ -211,7 +301,7 @@ void WorkerThread::SendWorkerThreadExposeComplete(usImage *pImage, bool bError)
 
 void WorkerThread::EnqueueWorkerThreadMoveRequest(Mount *pMount, const PHD_Point& vectorEndpoint, bool normalMove)
 {
-    m_interruptRequested &= ~INT_STOP;
+    ClearInterruptBits(INT_STOP);
 
     WORKER_THREAD_REQUEST message;
     memset(&message, 0, sizeof(message));
@@ -230,7 +320,7 @@ void WorkerThread::EnqueueWorkerThreadMoveRequest(Mount *pMount, const PHD_Point
 
 void WorkerThread::EnqueueWorkerThreadMoveRequest(Mount *pMount, const GUIDE_DIRECTION direction, int duration)
 {
-    m_interruptRequested &= ~INT_STOP;
+    ClearInterruptBits(INT_STOP);
 
     WORKER_THREAD_REQUEST message;
     memset(&message, 0, sizeof(message));
@@ -342,25 +432,25 @@ wxThread::ExitCode WorkerThread::Entry()
     Debug.AddLine("worker thread CoInitializeEx returns %x", hr);
 #endif
 
+    enum { LATENCY_LOG_INTERVAL = 100 };
+    unsigned int dispatched = 0;
+
     while (!bDone)
     {
         WORKER_THREAD_REQUEST message;
-        bool dummy;
-        wxMessageQueueError queueError = m_wakeupQueue.Receive(dummy);
+        DequeueMessage(&message);
 
-        Debug.AddLine("Worker thread wakes up");
+        double latency = (double)(LatencyStats::Now() - message.enqueueTime) / 1000.0;
 
-        assert(queueError == wxMSGQUEUE_NO_ERROR);
+        Debug.AddLine("Worker thread wakes up, request queued for %.2f ms", latency);
 
-        queueError = m_highPriorityQueue.ReceiveTimeout(0, message);
+        if (message.request == REQUEST_EXPOSE)
+            m_exposeLatency.Add(latency);
+        else if (message.request == REQUEST_MOVE)
+            m_moveLatency.Add(latency);
 
-        if (queueError == wxMSGQUEUE_TIMEOUT)
-        {
-            queueError = m_lowPriorityQueue.ReceiveTimeout(0, message);
-            assert(queueError != wxMSGQUEUE_TIMEOUT);
-        }
-
-        assert(queueError == wxMSGQUEUE_NO_ERROR);
+        if (++dispatched % LATENCY_LOG_INTERVAL == 0)
+            LogQueueLatency();
 
         switch(message.request)
         {
@@ -396,6 +486,8 @@ wxThread::ExitCode WorkerThread::Entry()
         bDone |= TestDestroy();
     }
 
+    LogQueueLatency();
+
     Debug.AddLine("WorkerThread::Entry() ends");
     Debug.Flush();
 
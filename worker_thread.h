@@ -44,15 +44,20 @@ class MyFrame;
  * second mount, so that on systems with two mounts (probably an AO and a telescope), the
  * second mount can be moving while we image and guide with the first mount.
  *
- * The worker threads have three queues, one for move requests (higher priority)
- * and one for exposure requests (lower priority) and one "wakeup queue". The wx queue
- * routines do not have a way to wait on multiple queues, so there is no easy way
- * to implement the dual queue priority model without a third queue.
+ * The worker threads have a single request queue protected by a mutex. Move and
+ * terminate requests are high priority: they are inserted after any other high
+ * priority requests but ahead of all exposure requests, so a move is never
+ * queued behind an exposure that has not started. The thread waits on a
+ * condition variable that is signalled on each enqueue.
  *
- * When something is enqueued on either of the work queues, a dummy message is
- * also enqueued on the wakeup queue, which wakes the thread up.  It then finds
- * the work item by looking first on the high priority queue and then the low
- * priority queue.
+ * The time each request spends in the queue is recorded, by request type, and
+ * the percentiles are written to the debug log every 100 requests and when
+ * the thread exits.
+ *
+ * Stop and terminate requests set interrupt bits. The bits are read without
+ * locking, but are only changed with m_interruptLock held, and every change
+ * wakes the threads waiting in MilliSleep, so a wait is interrupted as soon
+ * as the stop is requested.
  *
  */
 
@@ -86,14 +91,22 @@ class WorkerThread : public wxThread
     {
         WORKER_REQUEST_TYPE request;
         WORKER_REQUEST_ARGS args;
+        wxLongLong_t enqueueTime;   // LatencyStats::Now() when queued
     };
 
     MyFrame *m_pFrame;
     volatile unsigned int m_interruptRequested;
+    wxMutex m_interruptLock;
+    wxCondition m_interruptChanged;
     volatile bool m_killable;
-    wxMessageQueue<bool> m_wakeupQueue;
-    wxMessageQueue<WORKER_THREAD_REQUEST> m_highPriorityQueue;
-    wxMessageQueue<WORKER_THREAD_REQUEST> m_lowPriorityQueue;
+
+    wxMutex m_queueLock;
+    wxCondition m_queueNotEmpty;
+    std::deque<WORKER_THREAD_REQUEST> m_queue;
+    unsigned int m_highPriorityCount;   // high priority requests at the front of m_queue
+
+    LatencyStats m_exposeLatency;
+    LatencyStats m_moveLatency;
 
 public:
 
@@ -114,6 +127,10 @@ public:
 
 private:
     wxThread::ExitCode Entry();
+    void DequeueMessage(WORKER_THREAD_REQUEST *message);
+    void LogQueueLatency(void);
+    void SetInterruptBits(unsigned int bits);
+    void ClearInterruptBits(unsigned int bits);
 
     /*
      * A worker thread is used only for long running tasks:
@@ -175,7 +192,7 @@ protected:
 
 inline void WorkerThread::RequestStop(void)
 {
-    m_interruptRequested |= INT_STOP;
+    SetInterruptBits(INT_STOP);
 }
 
 inline WorkerThread *WorkerThread::This(void)